@@ -0,0 +1,184 @@
+#include "cpp_generator.hpp"
+#include "dfa_table.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace {
+bool is_identifier_start(char symbol)
+{
+    return symbol == '_' || (symbol >= 'a' && symbol <= 'z') || (symbol >= 'A' && symbol <= 'Z');
+}
+
+bool is_identifier_symbol(char symbol) { return is_identifier_start(symbol) || (symbol >= '0' && symbol <= '9'); }
+
+// The smallest unsigned type holding values below the given bound.
+std::string_view uint_type(unsigned bound)
+{
+    if (bound <= 1u << 8)
+        return "std::uint8_t";
+    if (bound <= 1u << 16)
+        return "std::uint16_t";
+    return "std::uint32_t";
+}
+
+std::string char_literal(char symbol)
+{
+    if (symbol == '\'' || symbol == '\\')
+        return {'\'', '\\', symbol, '\''};
+    if (symbol >= ' ' && symbol <= '~')
+        return {'\'', symbol, '\''};
+
+    char escaped[8];
+    std::snprintf(escaped, sizeof(escaped), "'\\x%02x'", static_cast<unsigned char>(symbol));
+    return escaped;
+}
+
+// Comma-separated values, wrapped into indented rows of the given length.
+template <typename T> std::string array_rows(const std::vector<T> &values, size_t row_length)
+{
+    std::string rows;
+    for (size_t i = 0; i < values.size(); ++i) {
+        rows += i % row_length == 0 ? "        " : " ";
+        rows += std::to_string(values[i]) + ",";
+        if (i % row_length == row_length - 1 || i + 1 == values.size())
+            rows += "\n";
+    }
+    return rows;
+}
+
+std::string generate_table(const DfaTable &table, std::string_view function_name)
+{
+    const auto num_of_states = table.get_num_of_states();
+    const auto num_of_classes = table.get_num_of_classes();
+
+    std::vector<unsigned> classes(256);
+    for (unsigned symbol = 0; symbol < 256; ++symbol)
+        classes[symbol] = table.get_class(static_cast<char>(symbol));
+
+    std::vector<unsigned> transitions;
+    for (unsigned state = 0; state < num_of_states; ++state) {
+        for (unsigned symbol_class = 0; symbol_class < num_of_classes; ++symbol_class)
+            transitions.push_back(table.next_by_class(state, symbol_class));
+    }
+
+    std::vector<unsigned> final(num_of_states);
+    for (unsigned state = 0; state < num_of_states; ++state)
+        final[state] = table.is_final(state);
+
+    std::string code;
+    code += "// Minimal DFA of " + std::to_string(num_of_states) + " states, including the dead state, and "
+            + std::to_string(num_of_classes) + " symbol classes.\n";
+    code += "inline bool " + std::string(function_name) + "(std::string_view word) noexcept\n{\n";
+    code += "    static constexpr " + std::string(uint_type(num_of_classes)) + " classes[256] = {\n";
+    code += array_rows(classes, 16);
+    code += "    };\n";
+    code += "    static constexpr " + std::string(uint_type(num_of_states)) + " transitions["
+            + std::to_string(num_of_states) + "][" + std::to_string(num_of_classes) + "] = {\n";
+    code += array_rows(transitions, num_of_classes);
+    code += "    };\n";
+    code += "    static constexpr bool final[" + std::to_string(num_of_states) + "] = {\n";
+    code += array_rows(final, 16);
+    code += "    };\n\n";
+    code += "    unsigned state = " + std::to_string(table.get_initial_state()) + ";\n";
+    code += "    for (const auto symbol : word) {\n";
+    code += "        state = transitions[state][classes[static_cast<unsigned char>(symbol)]];\n";
+    code += "        if (state == " + std::to_string(table.get_dead_state()) + ")\n";
+    code += "            return false;\n";
+    code += "    }\n";
+    code += "    return final[state];\n";
+    code += "}\n";
+    return code;
+}
+
+std::string generate_switch(const DfaTable &table, std::string_view function_name)
+{
+    const auto dead_state = table.get_dead_state();
+    const auto &alphabet = table.get_alphabet();
+
+    std::string code;
+    code += "// Minimal DFA of " + std::to_string(table.get_num_of_states()) + " states, including the dead state.\n";
+    code += "inline bool " + std::string(function_name) + "(std::string_view word) noexcept\n{\n";
+    if (table.get_initial_state() == dead_state) {
+        code += "    static_cast<void>(word);\n";
+        code += "    return false;\n";
+        code += "}\n";
+        return code;
+    }
+
+    // Only states which are jumped to get a label, since unused labels are warned about.
+    std::set<unsigned> targets;
+    for (unsigned state = 0; state < dead_state; ++state) {
+        for (const auto &symbol : alphabet)
+            targets.insert(table.next(state, symbol));
+    }
+
+    code += "    auto it = word.begin();\n";
+    code += "    const auto end = word.end();\n";
+    // The initial state is numbered 0 and comes first, so it is entered by falling through.
+    for (unsigned state = 0; state < dead_state; ++state) {
+        code += "\n";
+        if (targets.contains(state))
+            code += "state_" + std::to_string(state) + ":\n";
+        code += "    if (it == end)\n";
+        code += std::string("        return ") + (table.is_final(state) ? "true" : "false") + ";\n";
+        code += "    switch (*it++) {\n";
+
+        std::map<unsigned, std::string> symbols_by_target;
+        for (const auto &symbol : alphabet) {
+            const auto to_state = table.next(state, symbol);
+            if (to_state != dead_state)
+                symbols_by_target[to_state] += symbol;
+        }
+        for (const auto &[to_state, symbols] : symbols_by_target) {
+            for (const auto &symbol : symbols)
+                code += "    case " + char_literal(symbol) + ":\n";
+            code += "        goto state_" + std::to_string(to_state) + ";\n";
+        }
+
+        code += "    default:\n";
+        code += "        return false;\n";
+        code += "    }\n";
+    }
+    code += "}\n";
+    return code;
+}
+} // namespace
+
+bool CppGenerator::is_identifier(std::string_view name)
+{
+    return !name.empty() && is_identifier_start(name[0]) && std::ranges::all_of(name, is_identifier_symbol);
+}
+
+std::string CppGenerator::to_identifier(std::string_view name)
+{
+    std::string identifier(name);
+    std::ranges::replace_if(identifier, [](char symbol) { return !is_identifier_symbol(symbol); }, '_');
+    if (!is_identifier(identifier))
+        identifier.insert(0, "match_");
+    return identifier;
+}
+
+std::expected<std::string, std::string> CppGenerator::generate_function(
+    const FiniteAutomaton &automaton, std::string_view function_name, Style style)
+{
+    if (!is_identifier(function_name))
+        return std::unexpected("Not a valid function name: " + std::string(function_name));
+
+    const DfaTable table(automaton.minimize());
+    return style == Style::Table ? generate_table(table, function_name) : generate_switch(table, function_name);
+}
+
+std::string CppGenerator::generate_header(std::span<const std::string> functions)
+{
+    std::string code = "// Generated by the Finite Automata Toolbox.\n"
+                       "#pragma once\n\n"
+                       "#include <cstdint>\n"
+                       "#include <string_view>\n";
+    for (const auto &function : functions)
+        code += "\n" + function;
+    return code;
+}
@@ -0,0 +1,35 @@
+#ifndef CPP_GENERATOR_HPP
+#define CPP_GENERATOR_HPP
+
+#include "finite_automaton.hpp"
+
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Generation of C++ source code for matching the language of an automaton, so that it can be compiled into
+// a program which doesn't link the toolbox. The automaton is minimized first, and its table, with symbols
+// grouped into classes as in DfaTable, is written either as constant arrays or as a switch per state.
+namespace CppGenerator {
+enum class Style
+{
+    // Constant arrays of the symbol classes and the transitions, read in a loop.
+    Table,
+    // A label per state and a switch over the next symbol, jumping between the labels.
+    Switch,
+};
+
+bool is_identifier(std::string_view name);
+// The name with every symbol not allowed in identifiers replaced by '_', prefixed with "match_" if it
+// still isn't an identifier.
+std::string to_identifier(std::string_view name);
+
+// A function `inline bool function_name(std::string_view word) noexcept`.
+std::expected<std::string, std::string> generate_function(
+    const FiniteAutomaton &automaton, std::string_view function_name, Style style);
+// A header holding the given functions, along with the includes they need.
+std::string generate_header(std::span<const std::string> functions);
+} // namespace CppGenerator
+
+#endif // CPP_GENERATOR_HPP
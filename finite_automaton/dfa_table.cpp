@@ -0,0 +1,177 @@
+#include "dfa_table.hpp"
+#include "transition_graph.hpp"
+
+#include <limits>
+
+DfaTable::DfaTable(const FiniteAutomaton &automaton)
+{
+    const bool deterministic = automaton.is_deterministic();
+    std::optional<FiniteAutomaton> determinized;
+    const auto &dfa = deterministic ? automaton : determinized.emplace(automaton.determinize());
+    const TransitionGraph graph(dfa);
+    const auto num_of_dfa_states = graph.get_num_of_states();
+
+    // States that can lead to a final state, found by searching backwards from the final states.
+    std::vector<char> co_reachable(num_of_dfa_states, false);
+    std::vector<unsigned> state_stack;
+    for (const auto &state : dfa.get_final_states()) {
+        state_stack.push_back(*graph.get_state(state));
+        co_reachable[state_stack.back()] = true;
+    }
+    while (!state_stack.empty()) {
+        const auto current_state = state_stack.back();
+        state_stack.pop_back();
+        for (const auto &[_, state] : graph.predecessors(current_state)) {
+            if (!co_reachable[state]) {
+                co_reachable[state] = true;
+                state_stack.push_back(state);
+            }
+        }
+    }
+
+    // The successors of each state are sorted by symbol, so the states are numbered in the same
+    // breadth-first order as when visiting them symbol by symbol.
+    const unsigned unnumbered = std::numeric_limits<unsigned>::max();
+    std::vector<unsigned> live_ids(num_of_dfa_states, unnumbered);
+    std::vector<unsigned> live_states;
+    const auto initial_state = *graph.get_state(*dfa.get_initial_states().begin());
+    if (co_reachable[initial_state]) {
+        live_ids[initial_state] = 0;
+        live_states.push_back(initial_state);
+    }
+    for (size_t i = 0; i < live_states.size(); ++i) {
+        for (const auto &[_, to_state] : graph.successors(live_states[i])) {
+            if (co_reachable[to_state] && live_ids[to_state] == unnumbered) {
+                live_ids[to_state] = live_states.size();
+                live_states.push_back(to_state);
+            }
+        }
+    }
+
+    const unsigned num_of_live_states = live_states.size();
+    const unsigned dead_state = num_of_live_states;
+    m_num_of_states = num_of_live_states + 1;
+    m_initial_state = live_states.empty() ? dead_state : 0;
+
+    m_alphabet = std::string(dfa.get_alphabet().begin(), dfa.get_alphabet().end());
+    std::array<unsigned, 256> symbol_indices{};
+    for (size_t i = 0; i < m_alphabet.size(); ++i)
+        symbol_indices[static_cast<unsigned char>(m_alphabet[i])] = i;
+
+    std::vector<std::vector<unsigned>> symbol_columns(
+        m_alphabet.size(), std::vector<unsigned>(num_of_live_states, dead_state));
+    for (unsigned state = 0; state < num_of_live_states; ++state) {
+        for (const auto &[symbol, to_state] : graph.successors(live_states[state])) {
+            if (live_ids[to_state] != unnumbered)
+                symbol_columns[symbol_indices[static_cast<unsigned char>(symbol)]][state] = live_ids[to_state];
+        }
+    }
+
+    // Symbols with the same column of target states form a class.
+    std::map<std::vector<unsigned>, unsigned> columns;
+    columns[std::vector<unsigned>(num_of_live_states, dead_state)] = 0;
+    for (size_t i = 0; i < m_alphabet.size(); ++i) {
+        const unsigned new_class = columns.size();
+        m_classes[static_cast<unsigned char>(m_alphabet[i])] =
+            columns.insert({std::move(symbol_columns[i]), new_class}).first->second;
+    }
+    m_num_of_classes = columns.size();
+
+    m_transitions.assign(m_num_of_states * m_num_of_classes, dead_state);
+    for (const auto &[column, symbol_class] : columns) {
+        for (unsigned state = 0; state < num_of_live_states; ++state)
+            m_transitions[state * m_num_of_classes + symbol_class] = column[state];
+    }
+
+    m_final.assign(m_num_of_states, false);
+    for (unsigned state = 0; state < num_of_live_states; ++state)
+        m_final[state] = dfa.get_final_states().contains(graph.get_original_state(live_states[state]));
+
+    if (deterministic) {
+        for (unsigned state = 0; state < num_of_dfa_states; ++state)
+            m_state_map[graph.get_original_state(state)] = live_ids[state] == unnumbered ? dead_state : live_ids[state];
+    }
+}
+
+bool DfaTable::accepts(std::string_view word) const
+{
+    const auto dead_state = get_dead_state();
+
+    auto state = m_initial_state;
+    for (const auto &symbol : word) {
+        state = next(state, symbol);
+        if (state == dead_state)
+            return false;
+    }
+
+    return is_final(state);
+}
+
+void DfaTable::accepts_all(std::span<const std::string_view> words, std::span<bool> results) const
+{
+    constexpr size_t num_of_lanes = 8;
+    constexpr size_t no_word = std::numeric_limits<size_t>::max();
+    const auto dead_state = get_dead_state();
+
+    struct Lane
+    {
+        size_t word = no_word;
+        const char *position = nullptr, *end = nullptr;
+        unsigned state = 0;
+    };
+    std::array<Lane, num_of_lanes> lanes;
+
+    // Gives the lane the next word which takes any steps at all, writing out the results of the ones which don't
+    // on the way. Without any words left, the lane stays empty.
+    size_t next_word = 0;
+    size_t num_of_filled = 0;
+    const auto refill = [&](Lane &lane) {
+        for (; next_word < words.size(); ++next_word) {
+            const auto word = words[next_word];
+            if (word.empty() || m_initial_state == dead_state) {
+                results[next_word] = is_final(m_initial_state);
+                continue;
+            }
+            lane = {next_word++, word.data(), word.data() + word.size(), m_initial_state};
+            ++num_of_filled;
+            return;
+        }
+        lane.word = no_word;
+    };
+    for (auto &lane : lanes)
+        refill(lane);
+
+    // While all of the lanes have words, each of them takes a step in turn, and a lane whose word has ended or died
+    // is refilled with the next word right away, so that the lanes keep running however the lengths of the words
+    // vary. The checks are rarely taken, so they are predicted well.
+    while (num_of_filled == num_of_lanes) {
+        for (auto &lane : lanes) {
+            lane.state = next(lane.state, *lane.position++);
+            if (lane.position == lane.end || lane.state == dead_state) [[unlikely]] {
+                results[lane.word] = is_final(lane.state);
+                --num_of_filled;
+                refill(lane);
+            }
+        }
+    }
+
+    // Once the words run out, the ones left in the lanes are finished one at a time.
+    for (const auto &lane : lanes) {
+        if (lane.word == no_word)
+            continue;
+        auto state = lane.state;
+        for (auto position = lane.position; position != lane.end && state != dead_state; ++position)
+            state = next(state, *position);
+        results[lane.word] = is_final(state);
+    }
+}
+
+const std::string &DfaTable::get_alphabet() const { return m_alphabet; }
+
+std::optional<unsigned> DfaTable::get_state(unsigned automaton_state) const
+{
+    auto it = m_state_map.find(automaton_state);
+    if (it == m_state_map.end())
+        return std::nullopt;
+    return it->second;
+}
@@ -0,0 +1,65 @@
+#ifndef DFA_TABLE_HPP
+#define DFA_TABLE_HPP
+
+#include "finite_automaton.hpp"
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Flat transition table of a deterministic automaton, meant for executing it fast.
+//
+// The live states (reachable ones which can lead to a final state) are numbered densely in
+// breadth-first order, starting with the initial state, and all other states are merged into
+// a single dead state looping on every symbol, numbered last. The symbols are grouped into
+// classes of symbols which behave the same in every state, with class 0 holding the symbols
+// that always lead to the dead state, including those not in the alphabet.
+class DfaTable
+{
+  public:
+    // Non-deterministic automata are determinized first.
+    explicit DfaTable(const FiniteAutomaton &automaton);
+
+    bool accepts(std::string_view word) const;
+    // Whether each word is accepted, written to the result of the same index (there must be at least as many
+    // results as words). Several words are run at once, in interleaved lanes, so that the latency of
+    // each table lookup is hidden behind the independent lookups of the other lanes; a lane whose word
+    // ends is given the next word right away.
+    void accepts_all(std::span<const std::string_view> words, std::span<bool> results) const;
+
+    unsigned get_initial_state() const { return m_initial_state; }
+    unsigned get_dead_state() const { return m_num_of_states - 1; }
+    unsigned get_num_of_states() const { return m_num_of_states; }
+    unsigned get_num_of_classes() const { return m_num_of_classes; }
+    unsigned get_class(char symbol) const { return m_classes[static_cast<unsigned char>(symbol)]; }
+    bool is_final(unsigned state) const { return m_final[state]; }
+
+    unsigned next(unsigned state, char symbol) const { return next_by_class(state, get_class(symbol)); }
+    unsigned next_by_class(unsigned state, unsigned symbol_class) const
+    {
+        return m_transitions[state * m_num_of_classes + symbol_class];
+    }
+
+    // The alphabet of the automaton, in increasing order.
+    const std::string &get_alphabet() const;
+    // The table state standing for a state of the automaton the table was built from, if it was
+    // deterministic. States which aren't live are mapped to the dead state.
+    std::optional<unsigned> get_state(unsigned automaton_state) const;
+
+  private:
+    std::array<std::uint16_t, 256> m_classes{};
+    unsigned m_num_of_classes;
+    unsigned m_num_of_states;
+    unsigned m_initial_state;
+    std::vector<unsigned> m_transitions;
+    std::vector<char> m_final;
+    std::string m_alphabet;
+    std::map<unsigned, unsigned> m_state_map;
+};
+
+#endif // DFA_TABLE_HPP
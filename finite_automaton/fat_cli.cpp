@@ -0,0 +1,259 @@
+#include "cpp_generator.hpp"
+#include "finite_automaton.hpp"
+#include "mapped_file.hpp"
+#include "scene_file.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace {
+constexpr std::string_view usage =
+    "Usage: fat_cli [-j jobs] [-t] [-c style] -o directory operations file...\n"
+    "Runs a comma-separated pipeline of operations on the automata of each file, which is either a scene\n"
+    "saved by the GUI (*.fat), an automaton in the line-based transition format (*.fa) or a text file with\n"
+    "one regex per line, and saves the resulting automata to a scene of the same name in the output directory.\n"
+    "  unary operations, applied to each automaton:\n"
+    "    determinize, complete, reverse, minimize, complement, trim\n"
+    "  binary operations, folding all automata of a file into one:\n"
+    "    union, intersection, difference\n"
+    "  -j  number of files processed at once (all hardware threads by default)\n"
+    "  -t  report how long each file took\n"
+    "  -c  save C++ matchers of the resulting automata to a header (*.hpp) instead of a scene, where the\n"
+    "      style is table (constant arrays) or switch (a switch per state)\n"
+    "  -o  output directory\n";
+
+using unary_operation_t = FiniteAutomaton (FiniteAutomaton::*)() const;
+using binary_operation_t = FiniteAutomaton (FiniteAutomaton::*)(const FiniteAutomaton &) const;
+using operation_t = std::variant<unary_operation_t, binary_operation_t>;
+
+const std::map<std::string_view, operation_t> operations = {
+    {"determinize", &FiniteAutomaton::determinize},
+    {"complete", &FiniteAutomaton::complete},
+    {"reverse", &FiniteAutomaton::reverse},
+    {"minimize", &FiniteAutomaton::minimize},
+    {"complement", &FiniteAutomaton::complement},
+    {"trim", &FiniteAutomaton::trim},
+    {"union", &FiniteAutomaton::union_with},
+    {"intersection", &FiniteAutomaton::intersection_with},
+    {"difference", &FiniteAutomaton::difference_with},
+};
+
+// Horizontal distance between the automata laid out on a scene created from regexes.
+constexpr double layout_spacing = 300;
+
+std::optional<std::vector<operation_t>> parse_pipeline(std::string_view pipeline)
+{
+    std::vector<operation_t> parsed;
+    while (!pipeline.empty()) {
+        const auto name_end = std::min(pipeline.find(','), pipeline.size());
+        auto it = operations.find(pipeline.substr(0, name_end));
+        if (it == operations.end())
+            return std::nullopt;
+        parsed.push_back(it->second);
+        pipeline.remove_prefix(std::min(name_end + 1, pipeline.size()));
+    }
+
+    return parsed;
+}
+
+std::expected<std::vector<SceneFile::Item>, std::string> load(const std::filesystem::path &path)
+{
+    auto file = MappedFile::open(path.string());
+    if (!file)
+        return std::unexpected(file.error());
+
+    if (path.extension() == ".fat")
+        return SceneFile::read(file->get_contents());
+
+    if (path.extension() == ".fa") {
+        auto automaton = FiniteAutomaton::from_text(file->get_contents());
+        if (!automaton)
+            return std::unexpected(automaton.error());
+        return std::vector<SceneFile::Item>{{std::move(*automaton), 0, 0}};
+    }
+
+    auto automata = SceneFile::read_regexes(file->get_contents());
+    if (!automata)
+        return std::unexpected(automata.error());
+
+    std::vector<SceneFile::Item> items;
+    for (auto &automaton : *automata)
+        items.push_back({std::move(automaton), layout_spacing * items.size(), 0});
+    return items;
+}
+
+void run_pipeline(std::vector<SceneFile::Item> &items, const std::vector<operation_t> &pipeline)
+{
+    for (const auto &operation : pipeline) {
+        if (const auto *unary_operation = std::get_if<unary_operation_t>(&operation)) {
+            for (auto &item : items)
+                item.automaton = (item.automaton.**unary_operation)();
+        } else if (!items.empty()) {
+            const auto binary_operation = std::get<binary_operation_t>(operation);
+            for (size_t i = 1; i < items.size(); ++i)
+                items[0].automaton = (items[0].automaton.*binary_operation)(items[i].automaton);
+            items.resize(1, items[0]);
+        }
+    }
+}
+
+// Matchers are named after the file, with the index of the automaton appended when there are several.
+std::expected<std::string, std::string> generate_matchers(
+    const std::filesystem::path &input, const std::vector<SceneFile::Item> &items, CppGenerator::Style style)
+{
+    const auto name = CppGenerator::to_identifier(input.stem().string());
+
+    std::vector<std::string> functions;
+    for (size_t i = 0; i < items.size(); ++i) {
+        const auto function_name = items.size() == 1 ? name : name + "_" + std::to_string(i);
+        auto function = CppGenerator::generate_function(items[i].automaton, function_name, style);
+        if (!function)
+            return std::unexpected(function.error());
+        functions.push_back(std::move(*function));
+    }
+
+    return CppGenerator::generate_header(functions);
+}
+
+std::optional<std::string> save(const std::filesystem::path &path, std::string_view contents)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(contents.data(), contents.size()))
+        return "Cannot write file: " + path.string();
+    return std::nullopt;
+}
+
+// Processes one file, returning the line to report about it.
+std::string process(const std::filesystem::path &input, const std::filesystem::path &output_directory,
+                    const std::vector<operation_t> &pipeline, std::optional<CppGenerator::Style> cpp_style,
+                    bool report_time, bool &failed)
+{
+    using clock = std::chrono::steady_clock;
+    const auto milliseconds = [](clock::duration duration) {
+        return std::to_string(std::chrono::duration<double, std::milli>(duration).count()) + " ms";
+    };
+
+    const auto load_start = clock::now();
+    auto items = load(input);
+    if (!items) {
+        failed = true;
+        return "fat_cli: " + input.string() + ": " + items.error() + "\n";
+    }
+
+    const auto run_start = clock::now();
+    run_pipeline(*items, pipeline);
+
+    const auto save_start = clock::now();
+    const auto output = output_directory / input.filename().replace_extension(cpp_style ? ".hpp" : ".fat");
+    auto contents = cpp_style ? generate_matchers(input, *items, *cpp_style) : SceneFile::write(*items);
+    if (!contents) {
+        failed = true;
+        return "fat_cli: " + input.string() + ": " + contents.error() + "\n";
+    }
+    if (auto error = save(output, *contents)) {
+        failed = true;
+        return "fat_cli: " + input.string() + ": " + *error + "\n";
+    }
+    const auto end = clock::now();
+
+    if (!report_time)
+        return "";
+    return input.string() + ": load " + milliseconds(run_start - load_start) + ", operations "
+           + milliseconds(save_start - run_start) + ", save " + milliseconds(end - save_start) + "\n";
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    unsigned num_of_jobs = 0;
+    bool report_time = false;
+    std::optional<CppGenerator::Style> cpp_style;
+    std::optional<std::filesystem::path> output_directory;
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; ++i) {
+        const std::string_view option = argv[i];
+        if (option == "-t") {
+            report_time = true;
+        } else if (option == "-c" && i + 1 < argc) {
+            const std::string_view style = argv[++i];
+            if (style == "table") {
+                cpp_style = CppGenerator::Style::Table;
+            } else if (style == "switch") {
+                cpp_style = CppGenerator::Style::Switch;
+            } else {
+                std::cerr << usage;
+                return 2;
+            }
+        } else if (option == "-o" && i + 1 < argc) {
+            output_directory = argv[++i];
+        } else if (option == "-j" && i + 1 < argc) {
+            const std::string_view value = argv[++i];
+            if (std::from_chars(value.data(), value.data() + value.size(), num_of_jobs).ec != std::errc{}) {
+                std::cerr << usage;
+                return 2;
+            }
+        } else {
+            std::cerr << usage;
+            return 2;
+        }
+    }
+
+    const auto pipeline = i < argc ? parse_pipeline(argv[i++]) : std::nullopt;
+    if (!pipeline || !output_directory || i == argc) {
+        std::cerr << usage;
+        return 2;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(*output_directory, error);
+    if (error) {
+        std::cerr << "fat_cli: " << output_directory->string() << ": " << error.message() << '\n';
+        return 2;
+    }
+
+    const std::vector<std::filesystem::path> inputs(argv + i, argv + argc);
+    if (num_of_jobs == 0)
+        num_of_jobs = std::max(1u, std::thread::hardware_concurrency());
+
+    // Files are handed out to the workers one at a time, while the reports are kept in the order of the files.
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> reports(inputs.size());
+    std::vector<char> failures(inputs.size(), false);
+    std::atomic<size_t> next_input = 0;
+    {
+        std::vector<std::jthread> workers;
+        for (unsigned job = 0; job < std::min<size_t>(num_of_jobs, inputs.size()); ++job) {
+            workers.emplace_back([&]() {
+                for (size_t input = next_input++; input < inputs.size(); input = next_input++) {
+                    bool failed = false;
+                    reports[input] = process(
+                        inputs[input], *output_directory, *pipeline, cpp_style, report_time, failed);
+                    failures[input] = failed;
+                }
+            });
+        }
+    }
+
+    for (size_t input = 0; input < inputs.size(); ++input)
+        (failures[input] ? std::cerr : std::cout) << reports[input];
+
+    if (report_time) {
+        const auto total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        std::cout << "total: " << total.count() << " ms for " << inputs.size() << " files\n";
+    }
+
+    return std::ranges::any_of(failures, [](char failed) { return failed; }) ? 1 : 0;
+}
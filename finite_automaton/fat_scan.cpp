@@ -0,0 +1,85 @@
+#include "finite_automaton.hpp"
+#include "line_scanner.hpp"
+#include "mapped_file.hpp"
+
+#include <charconv>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace {
+constexpr std::string_view usage = "Usage: fat_scan [-x] [-c] [-n] [-j threads] regex file\n"
+                                   "Prints the lines of the file in which the regex finds a match.\n"
+                                   "  -x  only select lines which the regex matches whole\n"
+                                   "  -c  only print the number of selected lines\n"
+                                   "  -n  prefix each line with its number\n"
+                                   "  -j  number of threads to scan with (all hardware threads by default)\n";
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    auto mode = LineScanner::Mode::Substring;
+    bool count_only = false, print_numbers = false;
+    unsigned num_of_threads = 0;
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; ++i) {
+        const std::string_view option = argv[i];
+        if (option == "-x") {
+            mode = LineScanner::Mode::WholeLine;
+        } else if (option == "-c") {
+            count_only = true;
+        } else if (option == "-n") {
+            print_numbers = true;
+        } else if (option == "-j" && i + 1 < argc) {
+            const std::string_view value = argv[++i];
+            if (std::from_chars(value.data(), value.data() + value.size(), num_of_threads).ec != std::errc{}) {
+                std::cerr << usage;
+                return 2;
+            }
+        } else {
+            std::cerr << usage;
+            return 2;
+        }
+    }
+
+    if (argc - i != 2) {
+        std::cerr << usage;
+        return 2;
+    }
+
+    const auto automaton = FiniteAutomaton::construct(std::string(argv[i]));
+    if (!automaton) {
+        std::cerr << "fat_scan: " << automaton.error() << '\n';
+        return 2;
+    }
+
+    const auto file = MappedFile::open(argv[i + 1]);
+    if (!file) {
+        std::cerr << "fat_scan: " << file.error() << '\n';
+        return 2;
+    }
+
+    const LineScanner scanner(*automaton, mode);
+    if (count_only) {
+        const auto count = scanner.count(file->get_contents(), num_of_threads);
+        std::cout << count << '\n';
+        return count > 0 ? 0 : 1;
+    }
+
+    const auto lines = scanner.scan(file->get_contents(), num_of_threads);
+    std::string output;
+    for (const auto &[number, line] : lines) {
+        if (print_numbers)
+            output.append(std::to_string(number)).append(":");
+        output.append(line).append("\n");
+        if (output.size() >= 1 << 16) {
+            std::fwrite(output.data(), 1, output.size(), stdout);
+            output.clear();
+        }
+    }
+    std::fwrite(output.data(), 1, output.size(), stdout);
+
+    return lines.empty() ? 1 : 0;
+}
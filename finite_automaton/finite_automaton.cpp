@@ -1,15 +1,45 @@
 #include "finite_automaton.hpp"
+#include "dfa_table.hpp"
 #include "regex_driver.hpp"
+#include "transition_graph.hpp"
+#include "word_enumerator.hpp"
 
 #include <algorithm>
+#include <array>
+#include <charconv>
+#include <future>
+#include <limits>
+#include <mutex>
 #include <queue>
 #include <random>
 #include <ranges>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+
+struct FiniteAutomaton::Properties
+{
+    // Set on the automata the subset construction builds, whose states are all reachable and numbered in
+    // breadth-first order, so that determinizing them again wouldn't change anything.
+    bool determinized = false;
+
+    std::once_flag classified;
+    bool epsilon_free = false, deterministic = false, complete = false;
+
+    std::once_flag trimmed_known;
+    bool trimmed = false;
+
+    std::once_flag minimal_form_known;
+    // Left empty when the automaton is its own minimal form.
+    std::shared_ptr<const FiniteAutomaton> minimal_form;
+
+    std::once_flag canonical_hash_known;
+    std::size_t canonical_hash = 0;
+};
 
 std::expected<FiniteAutomaton, std::string> FiniteAutomaton::construct(
-    const std::set<char> &alphabet, const std::set<unsigned> &states, const std::set<unsigned> &initial_states,
-    const std::set<unsigned> &final_states,
-    const std::map<std::pair<unsigned, char>, std::set<unsigned>> &transition_function)
+    std::set<char> alphabet, std::set<unsigned> states, std::set<unsigned> initial_states,
+    std::set<unsigned> final_states, std::map<std::pair<unsigned, char>, std::set<unsigned>> transition_function)
 {
     const static auto is_subset = [](const auto &is, const auto &of) {
         return std::ranges::all_of(is, [&of](unsigned el) { return of.contains(el); });
@@ -51,7 +81,9 @@ std::expected<FiniteAutomaton, std::string> FiniteAutomaton::construct(
                                "symbols must form a "
                                "subset of the alphabet");
 
-    return FiniteAutomaton(alphabet, states, initial_states, final_states, transition_function);
+    return FiniteAutomaton(
+        std::move(alphabet), std::move(states), std::move(initial_states), std::move(final_states),
+        std::move(transition_function));
 }
 
 namespace {
@@ -67,7 +99,7 @@ std::pair<tf_t, unsigned> compile_regex(const RegexAST &ast, unsigned start_stat
                 auto [transition_function_left, end_state_left] = compile_regex(node.get_left(), start_state);
                 auto [transition_function_right, end_state_right] = compile_regex(node.get_right(), end_state_left);
                 transition_function_right.merge(transition_function_left);
-                return std::make_pair(transition_function_right, end_state_right);
+                return std::make_pair(std::move(transition_function_right), end_state_right);
             },
             [start_state](const AlternationAST &node) {
                 auto [transition_function_left, end_state_left] = compile_regex(node.get_left(), start_state + 1);
@@ -77,14 +109,14 @@ std::pair<tf_t, unsigned> compile_regex(const RegexAST &ast, unsigned start_stat
                 transition_function_right[{start_state, eps}].insert(end_state_left + 1);
                 transition_function_right[{end_state_left, eps}].insert(end_state_right + 1);
                 transition_function_right[{end_state_right, eps}].insert(end_state_right + 1);
-                return std::make_pair(transition_function_right, end_state_right + 1);
+                return std::make_pair(std::move(transition_function_right), end_state_right + 1);
             },
             [start_state](const ZeroOrOneAST &node) {
                 auto [transition_function, end_state] = compile_regex(node.get_operand(), start_state + 1);
                 transition_function[{start_state, eps}].insert(start_state + 1);
                 transition_function[{start_state, eps}].insert(end_state + 1);
                 transition_function[{end_state, eps}].insert(end_state + 1);
-                return std::make_pair(transition_function, end_state + 1);
+                return std::make_pair(std::move(transition_function), end_state + 1);
             },
             [start_state](const ZeroOrMoreAST &node) {
                 auto [transition_function, end_state] = compile_regex(node.get_operand(), start_state + 1);
@@ -92,22 +124,30 @@ std::pair<tf_t, unsigned> compile_regex(const RegexAST &ast, unsigned start_stat
                 transition_function[{start_state, eps}].insert(end_state + 1);
                 transition_function[{end_state, eps}].insert(start_state + 1);
                 transition_function[{end_state, eps}].insert(end_state + 1);
-                return std::make_pair(transition_function, end_state + 1);
+                return std::make_pair(std::move(transition_function), end_state + 1);
             },
             [start_state](const OneOrMoreAST &node) {
                 auto [transition_function, end_state] = compile_regex(node.get_operand(), start_state + 1);
                 transition_function[{start_state, eps}].insert(start_state + 1);
                 transition_function[{end_state, eps}].insert(start_state + 1);
                 transition_function[{end_state, eps}].insert(end_state + 1);
-                return std::make_pair(transition_function, end_state + 1);
+                return std::make_pair(std::move(transition_function), end_state + 1);
             },
             [start_state](const SymbolAST &node) {
                 tf_t transition_function;
                 transition_function[{start_state, node.get_symbol()}].insert(start_state + 1);
-                return std::make_pair(transition_function, start_state + 1);
+                return std::make_pair(std::move(transition_function), start_state + 1);
             }},
         ast);
 }
+
+std::set<char> alphabet_of(const tf_t &transition_function)
+{
+    auto alphabet_range =
+        std::views::keys(transition_function) | std::views::elements<1>
+        | std::views::filter([](unsigned symbol) { return symbol != FiniteAutomaton::epsilon_transition_value; });
+    return std::set<char>(alphabet_range.begin(), alphabet_range.end());
+}
 } // namespace
 
 std::expected<FiniteAutomaton, std::string> FiniteAutomaton::construct(const std::string &regex)
@@ -120,15 +160,162 @@ std::expected<FiniteAutomaton, std::string> FiniteAutomaton::construct(const std
 
     auto [transition_function, end_state] = compile_regex(*ast, 0);
 
-    auto alphabet_range = std::views::keys(transition_function) | std::views::elements<1>
-                          | std::views::filter([](unsigned symbol) { return symbol != epsilon_transition_value; });
-    std::set<char> alphabet(alphabet_range.begin(), alphabet_range.end());
-
     std::set<unsigned> states;
     for (unsigned s = 0; s <= end_state; ++s)
         states.insert(s);
 
-    return FiniteAutomaton(alphabet, states, {0}, {end_state}, transition_function);
+    auto alphabet = alphabet_of(transition_function);
+    return FiniteAutomaton(
+        std::move(alphabet), std::move(states), {0}, {end_state}, std::move(transition_function));
+}
+
+std::expected<FiniteAutomaton, std::string> FiniteAutomaton::construct(std::span<const std::string> regexes)
+{
+    tf_t transition_function;
+    std::set<unsigned> states, initial_states, final_states;
+
+    // The patterns are compiled one after the other, so their state
+    // ranges, and thus their single final states, follow their order.
+    unsigned start_state = 0;
+    for (size_t i = 0; i < regexes.size(); ++i) {
+        RegexDriver driver;
+        auto ast = driver.parse(regexes[i]);
+
+        if (!ast)
+            return std::unexpected("Regex parsing error in pattern " + std::to_string(i));
+
+        auto [pattern_transition_function, end_state] = compile_regex(*ast, start_state);
+        transition_function.merge(pattern_transition_function);
+
+        for (unsigned s = start_state; s <= end_state; ++s)
+            states.insert(s);
+        initial_states.insert(start_state);
+        final_states.insert(end_state);
+
+        start_state = end_state + 1;
+    }
+
+    auto alphabet = alphabet_of(transition_function);
+    return FiniteAutomaton(
+        std::move(alphabet), std::move(states), std::move(initial_states), std::move(final_states),
+        std::move(transition_function));
+}
+
+namespace {
+// Splits a line into tokens separated by whitespace (including the carriage return of CRLF line breaks).
+class Tokenizer
+{
+  public:
+    explicit Tokenizer(std::string_view line) : m_line(line) {}
+
+    std::string_view next()
+    {
+        const auto token_start = std::min(m_line.find_first_not_of(" \t\r"), m_line.size());
+        m_line.remove_prefix(token_start);
+        const auto token_end = std::min(m_line.find_first_of(" \t\r"), m_line.size());
+        const auto token = m_line.substr(0, token_end);
+        m_line.remove_prefix(token_end);
+        return token;
+    }
+
+  private:
+    std::string_view m_line;
+};
+
+std::optional<unsigned> parse_state(std::string_view token)
+{
+    unsigned state;
+    const auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), state);
+    if (error != std::errc{} || end != token.data() + token.size())
+        return std::nullopt;
+    return state;
+}
+} // namespace
+
+std::expected<FiniteAutomaton, std::string> FiniteAutomaton::from_text(std::string_view text)
+{
+    // Everything is read into flat arrays first, which are then sorted to build the sets in order.
+    std::vector<unsigned> states, initial_states, final_states;
+    std::vector<std::tuple<unsigned, char, unsigned>> transitions;
+    std::array<bool, 256> used_symbols{};
+
+    for (size_t line_number = 1; !text.empty(); ++line_number) {
+        const auto line_end = std::min(text.find('\n'), text.size());
+        auto line = text.substr(0, line_end);
+        text.remove_prefix(std::min(line_end + 1, text.size()));
+
+        Tokenizer tokens(line);
+        const auto first = tokens.next();
+        if (first.empty() || first.starts_with('#'))
+            continue;
+
+        const auto line_error = [&](const std::string &error) {
+            return std::unexpected(error + " on line " + std::to_string(line_number));
+        };
+
+        if (auto from_state = parse_state(first)) {
+            const auto symbol = tokens.next();
+            const auto to_state = parse_state(tokens.next());
+            if (symbol.size() != 1 || !to_state || !tokens.next().empty())
+                return line_error("Invalid transition");
+            transitions.emplace_back(*from_state, symbol[0], *to_state);
+            used_symbols[static_cast<unsigned char>(symbol[0])] = true;
+            continue;
+        }
+
+        if (first == "alphabet") {
+            for (auto token = tokens.next(); !token.empty(); token = tokens.next()) {
+                if (token.size() != 1 || token[0] == epsilon_transition_value)
+                    return line_error("Invalid symbol");
+                used_symbols[static_cast<unsigned char>(token[0])] = true;
+            }
+            continue;
+        }
+
+        auto *listed_states = first == "initial" ? &initial_states
+                              : first == "final" ? &final_states
+                              : first == "states" ? &states
+                                                  : nullptr;
+        if (!listed_states)
+            return line_error("Unknown line");
+        for (auto token = tokens.next(); !token.empty(); token = tokens.next()) {
+            auto state = parse_state(token);
+            if (!state)
+                return line_error("Invalid state");
+            listed_states->push_back(*state);
+        }
+    }
+
+    // All states mentioned anywhere exist, so no subset checks are needed.
+    states.insert(states.end(), initial_states.begin(), initial_states.end());
+    states.insert(states.end(), final_states.begin(), final_states.end());
+    for (const auto &[from_state, symbol, to_state] : transitions) {
+        states.push_back(from_state);
+        states.push_back(to_state);
+    }
+
+    const auto to_set = [](std::vector<unsigned> &values) {
+        std::ranges::sort(values);
+        return std::set<unsigned>(values.begin(), values.end());
+    };
+
+    std::set<char> alphabet;
+    for (int symbol = std::numeric_limits<char>::min(); symbol <= std::numeric_limits<char>::max(); ++symbol) {
+        if (symbol != epsilon_transition_value && used_symbols[static_cast<unsigned char>(symbol)])
+            alphabet.insert(alphabet.end(), symbol);
+    }
+
+    std::ranges::sort(transitions);
+    std::map<std::pair<unsigned, char>, std::set<unsigned>> transition_function;
+    for (const auto &[from_state, symbol, to_state] : transitions) {
+        auto it = transition_function.emplace_hint(
+            transition_function.end(), std::pair{from_state, symbol}, std::set<unsigned>{});
+        it->second.insert(it->second.end(), to_state);
+    }
+
+    return FiniteAutomaton(
+        std::move(alphabet), to_set(states), to_set(initial_states), to_set(final_states),
+        std::move(transition_function));
 }
 
 bool FiniteAutomaton::accepts(const std::string &word) const
@@ -152,6 +339,26 @@ bool FiniteAutomaton::accepts(const std::string &word) const
     return std::ranges::any_of(current_states, [this](const auto &s) { return m_final_states.contains(s); });
 }
 
+void FiniteAutomaton::accepts_all(std::span<const std::string_view> words, std::span<bool> results) const
+{
+    // Below this many words per thread, starting a thread costs more than it saves.
+    constexpr size_t min_words_per_thread = 4096;
+
+    const DfaTable table(*this);
+    const auto accept_range = [&](size_t from, size_t to) {
+        table.accepts_all(words.subspan(from, to - from), results.subspan(from, to - from));
+    };
+
+    const size_t num_of_threads = std::clamp<size_t>(
+        words.size() / min_words_per_thread, 1, std::max(1u, std::thread::hardware_concurrency()));
+    const size_t words_per_thread = (words.size() + num_of_threads - 1) / num_of_threads;
+
+    std::vector<std::jthread> threads;
+    for (size_t from = words_per_thread; from < words.size(); from += words_per_thread)
+        threads.emplace_back(accept_range, from, std::min(from + words_per_thread, words.size()));
+    accept_range(0, std::min(words_per_thread, words.size()));
+}
+
 std::vector<std::set<unsigned>> FiniteAutomaton::generate_match_steps(const std::string &word) const
 {
     std::vector<std::set<unsigned>> match_steps;
@@ -175,16 +382,25 @@ std::vector<std::set<unsigned>> FiniteAutomaton::generate_match_steps(const std:
 }
 
 FiniteAutomaton FiniteAutomaton::determinize() const
+{
+    if (properties().determinized)
+        return *this;
+    return determinize_with_subsets().first;
+}
+
+std::pair<FiniteAutomaton, std::vector<std::set<unsigned>>> FiniteAutomaton::determinize_with_subsets() const
 {
     std::set<unsigned> determinized_states;
     std::set<unsigned> determinized_final_states;
     std::map<std::pair<unsigned, char>, std::set<unsigned>> determinized_transition_function;
 
     std::map<std::set<unsigned>, unsigned> constructed_subsets;
+    std::vector<std::set<unsigned>> subsets;
 
     unsigned state_counter = 0;
     const auto initial_subset = epsilon_closure(m_initial_states);
     constructed_subsets[initial_subset] = state_counter;
+    subsets.push_back(initial_subset);
 
     // As an optimization, could use a bijective map structure
     // and instead of sets, store their state tags in the queue.
@@ -218,74 +434,210 @@ FiniteAutomaton FiniteAutomaton::determinize() const
             auto it = constructed_subsets.find(new_subset);
             if (it == constructed_subsets.end()) {
                 constructed_subsets[new_subset] = ++state_counter;
+                subsets.push_back(new_subset);
                 subset_queue.push(new_subset);
             }
             determinized_transition_function[{current_state, symbol}].insert(constructed_subsets[new_subset]);
         }
     }
 
-    return FiniteAutomaton(
-        m_alphabet, determinized_states, {0}, determinized_final_states, determinized_transition_function);
+    FiniteAutomaton determinized(
+        m_alphabet, std::move(determinized_states), {0}, std::move(determinized_final_states),
+        std::move(determinized_transition_function));
+    determinized.properties().determinized = true;
+    return {std::move(determinized), std::move(subsets)};
 }
 
-FiniteAutomaton FiniteAutomaton::complete() const
+FiniteAutomaton FiniteAutomaton::complete() const { return FiniteAutomaton(*this).into_complete(); }
+
+FiniteAutomaton FiniteAutomaton::into_complete() &&
 {
-    auto complete_transition_function = m_transition_function;
-    auto complete_states = m_states;
+    if (is_complete())
+        return std::move(*this);
+    m_properties = std::make_shared<Properties>();
 
-    // More efficient to just grab the last element since std::set is sorted,
-    // but we're leaving it like this for a more seamless potential container type switch.
-    const auto error_state = *std::ranges::max_element(m_states) + 1;
+    // Numbered right after the largest state, which keeps dense states dense.
+    const auto error_state = m_states.empty() ? 0 : *m_states.rbegin() + 1;
     bool error_state_added = false;
 
     for (const auto &state : m_states) {
         for (const auto &symbol : m_alphabet) {
-            if (m_transition_function.find({state, symbol}) == m_transition_function.end()) {
+            // Only missing transitions are inserted, so the existing ones are left as they are.
+            auto [it, inserted] = m_transition_function.try_emplace({state, symbol});
+            if (inserted) {
                 error_state_added = true;
-                complete_transition_function[{state, symbol}].insert(error_state);
+                it->second.insert(error_state);
             }
         }
     }
 
     if (error_state_added) {
-        complete_states.insert(error_state);
+        m_states.insert(error_state);
         for (const auto &symbol : m_alphabet)
-            complete_transition_function[{error_state, symbol}].insert(error_state);
+            m_transition_function[{error_state, symbol}].insert(error_state);
     }
 
-    return FiniteAutomaton(m_alphabet, complete_states, m_initial_states, m_final_states, complete_transition_function);
+    return std::move(*this);
 }
 
 FiniteAutomaton FiniteAutomaton::reverse() const
 {
-    std::map<std::pair<unsigned, char>, std::set<unsigned>> reverse_transition_function;
-
-    for (const auto &[k, v] : m_transition_function) {
-        for (const auto &state : v)
-            reverse_transition_function[{state, k.second}].insert(k.first);
-    }
+    return FiniteAutomaton(m_alphabet, m_states, m_final_states, m_initial_states, reverse_transition_function());
+}
 
-    return FiniteAutomaton(m_alphabet, m_states, m_final_states, m_initial_states, reverse_transition_function);
+FiniteAutomaton FiniteAutomaton::into_reverse() &&
+{
+    auto transition_function = reverse_transition_function();
+    return FiniteAutomaton(
+        std::move(m_alphabet), std::move(m_states), std::move(m_final_states), std::move(m_initial_states),
+        std::move(transition_function));
 }
 
-FiniteAutomaton FiniteAutomaton::minimize() const
+FiniteAutomaton FiniteAutomaton::minimize() const { return minimal_form(); }
+
+const FiniteAutomaton &FiniteAutomaton::minimal_form() const
 {
-    // Brzozowski's minimization.
-    return reverse().determinize().reverse().determinize();
+    std::call_once(properties().minimal_form_known, [this]() {
+        // Brzozowski's minimization.
+        auto minimal = reverse().determinize().into_reverse().determinize();
+        // The minimal form is its own.
+        std::call_once(minimal.properties().minimal_form_known, []() {});
+        properties().minimal_form = std::make_shared<const FiniteAutomaton>(std::move(minimal));
+    });
+    return properties().minimal_form ? *properties().minimal_form : *this;
 }
 
 FiniteAutomaton FiniteAutomaton::complement() const
 {
-    const auto complete_dfa = determinize().complete();
+    auto complete_dfa = determinize().into_complete();
+    complete_dfa.m_properties = std::make_shared<Properties>();
 
     std::set<unsigned> complement_final_states;
     std::ranges::set_difference(
         complete_dfa.m_states, complete_dfa.m_final_states,
         std::inserter(complement_final_states, complement_final_states.end()));
 
-    return FiniteAutomaton(
-        m_alphabet, complete_dfa.m_states, complete_dfa.m_initial_states, complement_final_states,
-        complete_dfa.m_transition_function);
+    complete_dfa.m_final_states = std::move(complement_final_states);
+    return complete_dfa;
+}
+
+FiniteAutomaton FiniteAutomaton::trim() const
+{
+    const TransitionGraph graph(*this);
+    const auto num_of_states = graph.get_num_of_states();
+
+    // Linear-time reachability from the given states, following either the successors or the predecessors.
+    const auto search = [&](const std::set<unsigned> &from_states, auto neighbours) {
+        std::vector<char> visited(num_of_states, false);
+        std::vector<unsigned> state_stack;
+        for (const auto &state : from_states) {
+            state_stack.push_back(*graph.get_state(state));
+            visited[state_stack.back()] = true;
+        }
+        while (!state_stack.empty()) {
+            const auto current_state = state_stack.back();
+            state_stack.pop_back();
+            for (const auto &[_, state] : (graph.*neighbours)(current_state)) {
+                if (!visited[state]) {
+                    visited[state] = true;
+                    state_stack.push_back(state);
+                }
+            }
+        }
+        return visited;
+    };
+    const auto reachable = search(m_initial_states, &TransitionGraph::successors);
+    const auto co_reachable = search(m_final_states, &TransitionGraph::predecessors);
+
+    std::vector<char> useful(num_of_states);
+    for (unsigned state = 0; state < num_of_states; ++state)
+        useful[state] = reachable[state] && co_reachable[state];
+    if (std::ranges::none_of(useful, [](char is_useful) { return is_useful; })) {
+        for (const auto &state : m_initial_states)
+            useful[*graph.get_state(state)] = true;
+    }
+
+    const auto is_useful = [&](unsigned state) { return useful[*graph.get_state(state)]; };
+    const auto useful_of = [&](const std::set<unsigned> &states) {
+        std::set<unsigned> useful_states;
+        std::ranges::copy_if(states, std::inserter(useful_states, useful_states.end()), is_useful);
+        return useful_states;
+    };
+
+    std::map<std::pair<unsigned, char>, std::set<unsigned>> transition_function;
+    for (const auto &[k, v] : m_transition_function) {
+        if (!is_useful(k.first))
+            continue;
+        auto to_states = useful_of(v);
+        if (!to_states.empty())
+            transition_function.emplace_hint(transition_function.end(), k, std::move(to_states));
+    }
+
+    FiniteAutomaton trimmed(
+        m_alphabet, useful_of(m_states), useful_of(m_initial_states), useful_of(m_final_states),
+        std::move(transition_function));
+    std::call_once(trimmed.properties().trimmed_known, [&]() { trimmed.properties().trimmed = true; });
+    return trimmed;
+}
+
+std::pair<FiniteAutomaton, std::vector<unsigned>> FiniteAutomaton::renumber_states() const &
+{
+    return FiniteAutomaton(*this).renumber_states();
+}
+
+std::pair<FiniteAutomaton, std::vector<unsigned>> FiniteAutomaton::renumber_states() &&
+{
+    std::vector<unsigned> original_states(m_states.begin(), m_states.end());
+    if (has_dense_states())
+        return {std::move(*this), std::move(original_states)};
+
+    const auto new_state = [&](unsigned state) -> unsigned {
+        return std::ranges::lower_bound(original_states, state) - original_states.begin();
+    };
+    const auto renumber = [&](const std::set<unsigned> &states) {
+        std::set<unsigned> renumbered;
+        for (const auto &state : states)
+            renumbered.insert(renumbered.end(), new_state(state));
+        return renumbered;
+    };
+
+    std::set<unsigned> states;
+    for (unsigned state = 0; state < original_states.size(); ++state)
+        states.insert(states.end(), state);
+
+    // Renumbering keeps the order of the states, so the transitions stay sorted.
+    std::map<std::pair<unsigned, char>, std::set<unsigned>> transition_function;
+    for (const auto &[k, v] : m_transition_function)
+        transition_function.emplace_hint(
+            transition_function.end(), std::pair{new_state(k.first), k.second}, renumber(v));
+
+    return {
+        FiniteAutomaton(
+            std::move(m_alphabet), std::move(states), renumber(m_initial_states), renumber(m_final_states),
+            std::move(transition_function)),
+        std::move(original_states)};
+}
+
+bool FiniteAutomaton::has_dense_states() const { return m_states.empty() || *m_states.rbegin() == m_states.size() - 1; }
+
+bool FiniteAutomaton::is_epsilon_free() const { return classify().epsilon_free; }
+
+bool FiniteAutomaton::is_deterministic() const { return classify().deterministic; }
+
+bool FiniteAutomaton::is_complete() const { return classify().complete; }
+
+bool FiniteAutomaton::is_trimmed() const
+{
+    std::call_once(properties().trimmed_known, [this]() {
+        properties().trimmed = trim().m_states.size() == m_states.size();
+    });
+    return properties().trimmed;
+}
+
+bool FiniteAutomaton::is_minimal() const
+{
+    // A DFA accepting the same language has at least as many useful states as the minimal one.
+    return is_deterministic() && minimal_form().m_states.size() == m_states.size();
 }
 
 FiniteAutomaton FiniteAutomaton::union_with(const FiniteAutomaton &other) const
@@ -305,115 +657,285 @@ FiniteAutomaton FiniteAutomaton::difference_with(const FiniteAutomaton &other) c
 
 namespace {
 
-unsigned precedence(const RegexAST &ast)
+// Alternation of the symbols labelling the transitions between two states.
+unsigned symbols_to_node(RegexDag &dag, const std::string &symbols)
 {
-    return std::visit(
-        overloaded{
-            [](const ConcatenationAST &node) { return 1; }, [](const AlternationAST &node) { return 0; },
-            [](const ZeroOrOneAST &node) { return 2; }, [](const ZeroOrMoreAST &node) { return 2; },
-            [](const OneOrMoreAST &node) { return 2; }, [](const SymbolAST &node) { return 3; }},
-        ast);
+    unsigned node = dag.symbol(symbols.front());
+    for (const auto &symbol : symbols | std::views::drop(1))
+        node = dag.alternation(node, dag.symbol(symbol));
+    return node;
 }
 
-std::string ast_to_string(const RegexAST &ast);
-
-std::string node_to_string(const RegexAST &node, const RegexAST &parent)
+// Iterative version of Tarjan's algorithm, so that long chains of states don't exhaust the
+// call stack. The components are returned in reverse topological order of the condensation.
+std::vector<std::vector<unsigned>> strongly_connected_components(const std::vector<std::vector<unsigned>> &successors)
 {
-    if (precedence(node) < precedence(parent))
-        return "(" + ast_to_string(node) + ")";
-    else
-        return ast_to_string(node);
+    const unsigned unvisited = std::numeric_limits<unsigned>::max();
+    const unsigned num_of_states = successors.size();
+
+    std::vector<unsigned> index(num_of_states, unvisited), low_link(num_of_states);
+    std::vector<bool> on_stack(num_of_states, false);
+    std::vector<unsigned> component_stack;
+    std::vector<std::pair<unsigned, size_t>> call_stack;
+    std::vector<std::vector<unsigned>> components;
+    unsigned index_counter = 0;
+
+    const auto visit = [&](unsigned state) {
+        index[state] = low_link[state] = index_counter++;
+        component_stack.push_back(state);
+        on_stack[state] = true;
+        call_stack.push_back({state, 0});
+    };
+
+    for (unsigned root = 0; root < num_of_states; ++root) {
+        if (index[root] != unvisited)
+            continue;
+
+        visit(root);
+        while (!call_stack.empty()) {
+            const unsigned state = call_stack.back().first;
+            const size_t next = call_stack.back().second++;
+
+            if (next < successors[state].size()) {
+                const unsigned successor = successors[state][next];
+                if (index[successor] == unvisited)
+                    visit(successor);
+                else if (on_stack[successor])
+                    low_link[state] = std::min(low_link[state], index[successor]);
+                continue;
+            }
+
+            call_stack.pop_back();
+            if (!call_stack.empty()) {
+                const unsigned parent = call_stack.back().first;
+                low_link[parent] = std::min(low_link[parent], low_link[state]);
+            }
+
+            if (low_link[state] == index[state]) {
+                auto &component = components.emplace_back();
+                unsigned member;
+                do {
+                    member = component_stack.back();
+                    component_stack.pop_back();
+                    on_stack[member] = false;
+                    component.push_back(member);
+                } while (member != state);
+            }
+        }
+    }
+
+    return components;
 }
 
-std::string ast_to_string(const RegexAST &ast)
+using path_labels_t = std::map<std::pair<unsigned, unsigned>, unsigned>;
+
+// Computes the labels of the paths that run from each entry to each exit of a component while staying
+// inside of it, by eliminating the component's states one by one. The labels are built in a DAG local
+// to the component, so that components can be eliminated in parallel.
+path_labels_t eliminate_component(
+    RegexDag &dag, const std::vector<unsigned> &component, const std::vector<unsigned> &entries,
+    const std::vector<unsigned> &exits, const std::vector<std::map<unsigned, std::string>> &labels)
 {
-    return std::visit(
-        overloaded{
-            [&ast](const ConcatenationAST &node) {
-                auto left = node_to_string(node.get_left(), ast);
-                auto right = node_to_string(node.get_right(), ast);
-                return left + right;
-            },
-            [&ast](const AlternationAST &node) {
-                auto left = node_to_string(node.get_left(), ast);
-                auto right = node_to_string(node.get_right(), ast);
-                return left + "|" + right;
-            },
-            [&ast](const ZeroOrOneAST &node) { return node_to_string(node.get_operand(), ast) + "?"; },
-            [&ast](const ZeroOrMoreAST &node) { return node_to_string(node.get_operand(), ast) + "*"; },
-            [&ast](const OneOrMoreAST &node) { return node_to_string(node.get_operand(), ast) + "+"; },
-            [&ast](const SymbolAST &node) { return std::string(1, node.get_symbol()); }},
-        ast);
+    // Local numbering: component states first, followed by a fresh
+    // source for each entry and a fresh sink for each exit.
+    const unsigned num_of_members = component.size();
+    const unsigned first_sink = num_of_members + entries.size();
+    std::map<unsigned, unsigned> local;
+    for (unsigned i = 0; i < num_of_members; ++i)
+        local[component[i]] = i;
+
+    std::vector<std::map<unsigned, unsigned>> out(first_sink + exits.size());
+    std::vector<std::set<unsigned>> in(out.size());
+    const auto add_label = [&](unsigned from, unsigned to, unsigned label) {
+        auto it = out[from].find(to);
+        if (it == out[from].end())
+            out[from].insert({to, label});
+        else
+            it->second = dag.alternation(it->second, label);
+        in[to].insert(from);
+    };
+
+    for (const auto &state : component) {
+        for (const auto &[to_state, symbols] : labels[state]) {
+            auto it = local.find(to_state);
+            if (it != local.end())
+                add_label(local[state], it->second, symbols_to_node(dag, symbols));
+        }
+    }
+    for (unsigned i = 0; i < entries.size(); ++i)
+        add_label(num_of_members + i, local[entries[i]], dag.epsilon());
+    for (unsigned i = 0; i < exits.size(); ++i)
+        add_label(local[exits[i]], first_sink + i, dag.epsilon());
+
+    for (unsigned q = 0; q < num_of_members; ++q) {
+        auto loop_it = out[q].find(q);
+        const auto loop = loop_it == out[q].end() ? dag.epsilon() : dag.zero_or_more(loop_it->second);
+
+        for (const auto &p : in[q]) {
+            if (p == q)
+                continue;
+            const auto through = dag.concatenation(out[p].at(q), loop);
+            for (const auto &[r, qr_label] : out[q]) {
+                if (r != q)
+                    add_label(p, r, dag.concatenation(through, qr_label));
+            }
+            out[p].erase(q);
+        }
+        for (const auto &[r, _] : out[q])
+            in[r].erase(q);
+        out[q].clear();
+        in[q].clear();
+    }
+
+    path_labels_t paths;
+    for (unsigned i = 0; i < entries.size(); ++i) {
+        for (const auto &[to, label] : out[num_of_members + i])
+            paths[{entries[i], exits[to - first_sink]}] = label;
+    }
+    return paths;
 }
 } // namespace
 
 std::optional<std::string> FiniteAutomaton::generate_regex() const
 {
-    const auto &eps = FiniteAutomaton::epsilon_transition_value;
-
-    // Note: Can also just be determinized instead of minimized,
-    // but this way the resulting regex will be shorter.
-    auto automaton = minimize().complete();
+    auto dag = generate_regex_dag();
+    if (!dag)
+        return std::nullopt;
+    else
+        return dag->expand();
+}
 
-    unsigned new_initial = automaton.m_states.size();
-    unsigned new_final = new_initial + 1;
+std::optional<RegexDag> FiniteAutomaton::generate_regex_dag() const
+{
+    // Note: Can also just be determinized instead of minimized, but this way the
+    // resulting regex will be shorter. The minimal automaton is also trimmed, so
+    // no component that can't lead to a final state takes part in the elimination.
+    const auto automaton = minimize();
+
+    // As in FiniteAutomaton::product_operation, this relies on the states of a
+    // determinized automaton forming a continuous sequence starting from 0.
+    const unsigned num_of_states = automaton.m_states.size();
+    const unsigned initial_state = *automaton.m_initial_states.begin();
+
+    // The symbols by which each state transitions to each of its successors.
+    std::vector<std::map<unsigned, std::string>> labels(num_of_states);
+    for (const auto &[k, v] : automaton.m_transition_function) {
+        for (const auto &to_state : v)
+            labels[k.first][to_state] += k.second;
+    }
 
-    automaton.m_states.insert({new_initial, new_final});
+    std::vector<std::vector<unsigned>> successors(num_of_states);
+    for (unsigned state = 0; state < num_of_states; ++state) {
+        for (const auto &[to_state, _] : labels[state])
+            successors[state].push_back(to_state);
+    }
 
-    automaton.m_transition_function[{new_initial, eps}].insert(*automaton.m_initial_states.begin());
-    for (const auto &state : automaton.m_final_states)
-        automaton.m_transition_function[{state, eps}].insert(new_final);
+    // Eliminating states globally mixes unrelated parts of the automaton, so each strongly
+    // connected component is converted on its own and the results are then stitched
+    // together along the (acyclic) graph of components, in topological order.
+    auto components = strongly_connected_components(successors);
+    std::ranges::reverse(components);
 
-    automaton.m_initial_states = {new_initial};
-    automaton.m_final_states = {new_final};
+    std::vector<unsigned> component_of(num_of_states);
+    for (unsigned i = 0; i < components.size(); ++i) {
+        for (const auto &state : components[i])
+            component_of[state] = i;
+    }
 
-    std::map<std::pair<unsigned, unsigned>, std::string> label_map;
-    for (const auto &[k, v] : automaton.m_transition_function) {
-        for (const auto &to_state : v) {
-            auto symbol_node = std::string(1, k.second);
-            auto it = label_map.find({k.first, to_state});
-            if (it == label_map.end())
-                label_map.insert({{k.first, to_state}, symbol_node});
-            else
-                it->second = it->second + "|" + symbol_node;
+    std::vector<std::vector<std::pair<unsigned, std::string>>> outside_predecessors(num_of_states);
+    std::vector<std::vector<unsigned>> entries(components.size()), exits(components.size());
+    for (unsigned state = 0; state < num_of_states; ++state) {
+        const auto component = component_of[state];
+        if (state == initial_state)
+            entries[component].push_back(state);
+        bool is_exit = automaton.m_final_states.contains(state);
+        for (const auto &[to_state, symbols] : labels[state]) {
+            if (component_of[to_state] != component) {
+                is_exit = true;
+                if (outside_predecessors[to_state].empty() && to_state != initial_state)
+                    entries[component_of[to_state]].push_back(to_state);
+                outside_predecessors[to_state].push_back({state, symbols});
+            }
         }
+        if (is_exit)
+            exits[component].push_back(state);
     }
 
-    auto states_copy = automaton.m_states;
-    for (const auto &q_state : automaton.m_states) {
-        if (q_state == new_initial || q_state == new_final)
-            continue;
+    // The components are independent of each other, so the non-trivial ones are
+    // eliminated in parallel, while singletons are handled inline when stitching.
+    std::vector<RegexDag> component_dags(components.size());
+    std::vector<path_labels_t> component_paths(components.size());
+    std::vector<unsigned> non_trivial;
+    for (unsigned i = 0; i < components.size(); ++i) {
+        if (components[i].size() > 1)
+            non_trivial.push_back(i);
+    }
+
+    const size_t num_of_tasks =
+        std::min<size_t>(non_trivial.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::future<void>> tasks;
+    for (size_t task = 0; task < num_of_tasks; ++task) {
+        tasks.push_back(std::async(std::launch::async, [&, task]() {
+            for (size_t i = task; i < non_trivial.size(); i += num_of_tasks) {
+                const auto component = non_trivial[i];
+                component_paths[component] = eliminate_component(
+                    component_dags[component], components[component], entries[component], exits[component], labels);
+            }
+        }));
+    }
+    for (auto &task : tasks)
+        task.get();
+
+    // Shared subexpressions, e.g. the label reaching a state with multiple outgoing
+    // transitions, are only stored once, since all of the labels live in a single DAG.
+    RegexDag dag;
+    const auto alternate = [&dag](std::optional<unsigned> &label, unsigned other) {
+        label = label ? dag.alternation(*label, other) : other;
+    };
 
-        states_copy.erase(q_state);
-        for (const auto &p_state : states_copy) {
-            for (const auto &r_state : states_copy) {
-                auto pq = label_map.find({p_state, q_state});
-                auto qr = label_map.find({q_state, r_state});
-                if (pq == label_map.end() || qr == label_map.end())
-                    continue;
-                auto qq = label_map.find({q_state, q_state});
-                auto pr = label_map.find({p_state, r_state});
-
-                auto result = "(" + pq->second + ")";
-                if (qq != label_map.end())
-                    result = result + "(" + qq->second + ")*";
-                result = result + "(" + qr->second + ")";
-                if (pr != label_map.end())
-                    result = result + "|" + "(" + pr->second + ")";
-
-                label_map[{p_state, r_state}] = result;
+    std::vector<std::optional<unsigned>> reaching(num_of_states);
+    std::optional<unsigned> result;
+    for (unsigned i = 0; i < components.size(); ++i) {
+        std::map<unsigned, std::optional<unsigned>> entry_labels;
+        for (const auto &entry : entries[i]) {
+            auto &entry_label = entry_labels[entry];
+            if (entry == initial_state)
+                entry_label = dag.epsilon();
+            for (const auto &[from_state, symbols] : outside_predecessors[entry]) {
+                if (reaching[from_state])
+                    alternate(entry_label, dag.concatenation(*reaching[from_state], symbols_to_node(dag, symbols)));
             }
         }
+
+        for (const auto &exit : exits[i]) {
+            if (components[i].size() == 1) {
+                const auto &entry_label = entry_labels[exit];
+                auto loop = labels[exit].find(exit);
+                if (entry_label && loop != labels[exit].end())
+                    reaching[exit] =
+                        dag.concatenation(*entry_label, dag.zero_or_more(symbols_to_node(dag, loop->second)));
+                else
+                    reaching[exit] = entry_label;
+            } else {
+                for (const auto &[entry, entry_label] : entry_labels) {
+                    auto path = component_paths[i].find({entry, exit});
+                    if (entry_label && path != component_paths[i].end())
+                        alternate(
+                            reaching[exit],
+                            dag.concatenation(*entry_label, dag.import(component_dags[i], path->second)));
+                }
+            }
+
+            if (automaton.m_final_states.contains(exit) && reaching[exit])
+                alternate(result, *reaching[exit]);
+        }
     }
 
-    // TODO: Work on getting a value based recursive variant
-    // up and running for the regex AST, which would allow for
-    // the direct creation of ASTs instead of string labels.
-    auto it = label_map.find({new_initial, new_final});
-    if (it == label_map.end())
+    if (!result)
         return std::nullopt;
-    else
-        return ast_to_string(*RegexDriver().parse(it->second));
+
+    dag.set_root(*result);
+    return dag;
 }
 
 namespace {
@@ -426,7 +948,8 @@ std::optional<std::string> FiniteAutomaton::generate_valid_word() const
     size_t max_valid = 200;
     unsigned max_state_visits = 100;
 
-    auto automaton = minimize().complete();
+    // Missing transitions lead to the implicit dead state, from which no valid word can be reached anyway.
+    auto automaton = minimize();
 
     std::vector<std::string> valid_words;
     std::vector<unsigned> state_visits(automaton.m_states.size(), 0);
@@ -441,7 +964,10 @@ std::optional<std::string> FiniteAutomaton::generate_valid_word() const
             valid_words.push_back(current_word);
 
         for (const auto &symbol : automaton.m_alphabet) {
-            unsigned new_state = *automaton.m_transition_function[{current_state, symbol}].begin();
+            auto it = automaton.m_transition_function.find({current_state, symbol});
+            if (it == automaton.m_transition_function.end())
+                continue;
+            unsigned new_state = *it->second.begin();
             if (state_visits[new_state] < max_state_visits) {
                 traversal_queue.push({new_state, current_word + symbol});
                 ++state_visits[new_state];
@@ -457,7 +983,427 @@ std::optional<std::string> FiniteAutomaton::generate_valid_word() const
     return valid_words[random_position(random_engine)];
 }
 
-std::optional<std::string> FiniteAutomaton::generate_invalid_word() const { return complement().generate_valid_word(); }
+std::optional<std::string> FiniteAutomaton::generate_invalid_word() const
+{
+    // The complement of the minimal form, which is deterministic already, doesn't need to be determinized again.
+    return minimal_form().complement().generate_valid_word();
+}
+
+WordEnumerator FiniteAutomaton::enumerate_words(unsigned max_length) const { return WordEnumerator(*this, max_length); }
+
+bool FiniteAutomaton::is_finite() const
+{
+    // All of the live states of the table are both reachable and co-reachable, so the
+    // language is infinite exactly when they form a cycle, which is looked for by
+    // repeatedly removing the live states that have no live predecessors left.
+    const DfaTable table(*this);
+    const auto dead_state = table.get_dead_state();
+
+    std::vector<unsigned> in_degrees(table.get_num_of_states(), 0);
+    for (unsigned state = 0; state < dead_state; ++state) {
+        for (unsigned symbol_class = 1; symbol_class < table.get_num_of_classes(); ++symbol_class)
+            ++in_degrees[table.next_by_class(state, symbol_class)];
+    }
+
+    std::vector<unsigned> removable;
+    for (unsigned state = 0; state < dead_state; ++state) {
+        if (in_degrees[state] == 0)
+            removable.push_back(state);
+    }
+
+    unsigned num_of_removed = 0;
+    while (!removable.empty()) {
+        const auto state = removable.back();
+        removable.pop_back();
+        ++num_of_removed;
+        for (unsigned symbol_class = 1; symbol_class < table.get_num_of_classes(); ++symbol_class) {
+            const auto to_state = table.next_by_class(state, symbol_class);
+            if (to_state != dead_state && --in_degrees[to_state] == 0)
+                removable.push_back(to_state);
+        }
+    }
+
+    return num_of_removed == dead_state;
+}
+
+namespace {
+std::uint64_t saturating_add(std::uint64_t a, std::uint64_t b)
+{
+    return a > std::numeric_limits<std::uint64_t>::max() - b ? std::numeric_limits<std::uint64_t>::max() : a + b;
+}
+
+std::uint64_t saturating_multiply(std::uint64_t a, std::uint64_t b)
+{
+    return b != 0 && a > std::numeric_limits<std::uint64_t>::max() / b ? std::numeric_limits<std::uint64_t>::max()
+                                                                        : a * b;
+}
+
+using count_matrix_t = std::vector<std::vector<std::uint64_t>>;
+
+count_matrix_t multiply(const count_matrix_t &a, const count_matrix_t &b)
+{
+    count_matrix_t product(a.size(), std::vector<std::uint64_t>(a.size(), 0));
+    for (size_t i = 0; i < a.size(); ++i) {
+        for (size_t k = 0; k < a.size(); ++k) {
+            if (a[i][k] == 0)
+                continue;
+            for (size_t j = 0; j < a.size(); ++j)
+                product[i][j] = saturating_add(product[i][j], saturating_multiply(a[i][k], b[k][j]));
+        }
+    }
+    return product;
+}
+
+std::vector<std::uint64_t> multiply(const count_matrix_t &matrix, const std::vector<std::uint64_t> &vector)
+{
+    std::vector<std::uint64_t> product(matrix.size(), 0);
+    for (size_t i = 0; i < matrix.size(); ++i) {
+        for (size_t j = 0; j < matrix.size(); ++j)
+            product[i] = saturating_add(product[i], saturating_multiply(matrix[i][j], vector[j]));
+    }
+    return product;
+}
+
+// The vector multiplied by the given power of the matrix, by exponentiation by squaring.
+std::vector<std::uint64_t> multiply_by_power(count_matrix_t matrix, std::uint64_t exponent,
+                                             std::vector<std::uint64_t> vector)
+{
+    for (; exponent != 0; exponent >>= 1) {
+        if (exponent & 1)
+            vector = multiply(matrix, vector);
+        if (exponent > 1)
+            matrix = multiply(matrix, matrix);
+    }
+    return vector;
+}
+
+// Total number of accepted words with lengths in the given range, by dynamic programming over the
+// lengths: the number of words of length n from a state is the sum of the numbers of words of
+// length n - 1 from its successors, each multiplied by the number of symbols leading to it. The
+// saturating arithmetic keeps every count exact up to the maximum, which it then stays at.
+std::uint64_t count_words_between(const FiniteAutomaton &automaton, unsigned min_length, unsigned max_length)
+{
+    const DfaTable table(automaton);
+    const auto dead_state = table.get_dead_state();
+    const auto initial_state = table.get_initial_state();
+
+    std::vector<std::uint64_t> class_sizes(table.get_num_of_classes(), 0);
+    for (const auto &symbol : table.get_alphabet())
+        ++class_sizes[table.get_class(symbol)];
+
+    std::vector<std::uint64_t> counts(table.get_num_of_states(), 0), next_counts(table.get_num_of_states(), 0);
+    for (unsigned state = 0; state < dead_state; ++state)
+        counts[state] = table.is_final(state) ? 1 : 0;
+
+    // The lengths are taken one at a time up to the number of live states: no state has words that long unless
+    // it reaches a loop, so finite languages are done by then.
+    std::uint64_t total = 0;
+    unsigned length = 0;
+    for (;; ++length) {
+        if (length >= min_length)
+            total = saturating_add(total, counts[initial_state]);
+
+        // Once no words of some length exist, no longer ones can exist either.
+        if (length == max_length || total == std::numeric_limits<std::uint64_t>::max()
+            || std::ranges::all_of(counts, [](std::uint64_t count) { return count == 0; }))
+            return total;
+        if (length == dead_state)
+            break;
+
+        for (unsigned state = 0; state < dead_state; ++state) {
+            next_counts[state] = 0;
+            for (unsigned symbol_class = 1; symbol_class < table.get_num_of_classes(); ++symbol_class) {
+                const auto count = counts[table.next_by_class(state, symbol_class)];
+                next_counts[state] =
+                    saturating_add(next_counts[state], saturating_multiply(class_sizes[symbol_class], count));
+            }
+        }
+        std::swap(counts, next_counts);
+    }
+    if (initial_state == dead_state)
+        return total;
+
+    // Words of any length exist, so the rest of the lengths are counted by exponentiation by squaring, which takes
+    // the cube of the number of states per squaring instead of a step per length. The matrix holds the numbers of
+    // symbols leading from each live state to each other one, and an extra state which counts the words of
+    // the lengths passed on the way: raising it to the power k + 1 sums the counts of the next k lengths.
+    count_matrix_t matrix(dead_state + 1, std::vector<std::uint64_t>(dead_state + 1, 0));
+    for (unsigned state = 0; state < dead_state; ++state) {
+        for (unsigned symbol_class = 1; symbol_class < table.get_num_of_classes(); ++symbol_class) {
+            const auto to_state = table.next_by_class(state, symbol_class);
+            if (to_state != dead_state)
+                matrix[state][to_state] += class_sizes[symbol_class];
+        }
+        matrix[state][dead_state] = counts[state];
+    }
+    matrix[dead_state][dead_state] = 1;
+
+    // The counts of the lengths from first_length to max_length, summed at the first of them and then carried
+    // over from the current length.
+    const std::uint64_t first_length = std::max(length + 1, min_length);
+    std::vector<std::uint64_t> sums(dead_state + 1, 0);
+    sums[dead_state] = 1;
+    sums = multiply_by_power(matrix, max_length - first_length + 1, std::move(sums));
+    sums[dead_state] = 0;
+    sums = multiply_by_power(std::move(matrix), first_length - length, std::move(sums));
+
+    return saturating_add(total, sums[initial_state]);
+}
+} // namespace
+
+std::uint64_t FiniteAutomaton::count_words(unsigned length) const { return count_words_between(*this, length, length); }
+
+std::uint64_t FiniteAutomaton::count_words_up_to(unsigned length) const
+{
+    return count_words_between(*this, 0, length);
+}
+
+namespace {
+// The format starts with the magic, then comes a version byte and a byte of flags.
+constexpr std::string_view serialization_magic = "FATA";
+constexpr std::uint8_t serialization_version = 1;
+constexpr std::uint8_t checksum_flag = 1;
+
+// FNV-1a, which is appended to the data (in little-endian) when checksumming.
+std::uint64_t checksum(std::string_view data)
+{
+    std::uint64_t hash = 0xcbf29ce484222325;
+    for (const auto &byte : data)
+        hash = (hash ^ static_cast<unsigned char>(byte)) * 0x100000001b3;
+    return hash;
+}
+
+void append_varint(std::string &data, std::uint64_t value)
+{
+    for (; value >= 0x80; value >>= 7)
+        data += static_cast<char>(value | 0x80);
+    data += static_cast<char>(value);
+}
+
+// Strictly increasing values are stored as the first one, followed by the gaps between them, minus one.
+void append_increasing(std::string &data, const auto &values, const auto &to_value)
+{
+    append_varint(data, values.size());
+    std::uint64_t previous = 0;
+    bool first = true;
+    for (const auto &value : values) {
+        const std::uint64_t current = to_value(value);
+        append_varint(data, first ? current : current - previous - 1);
+        previous = current;
+        first = false;
+    }
+}
+
+class VarintReader
+{
+  public:
+    explicit VarintReader(std::string_view data) : m_data(data) {}
+
+    std::optional<std::uint64_t> read()
+    {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64 && !m_data.empty(); shift += 7) {
+            const auto byte = static_cast<unsigned char>(m_data.front());
+            m_data.remove_prefix(1);
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        return std::nullopt;
+    }
+
+    // Reads a count of values, each of which takes at least a byte, so corrupt counts can't cause huge allocations.
+    std::optional<std::uint64_t> read_count()
+    {
+        auto count = read();
+        if (!count || *count > m_data.size())
+            return std::nullopt;
+        return count;
+    }
+
+    // Reads strictly increasing values, checking that they are all less than the given bound.
+    bool read_increasing(std::uint64_t bound, const auto &visitor)
+    {
+        auto count = read_count();
+        if (!count)
+            return false;
+
+        std::uint64_t previous = 0;
+        for (std::uint64_t i = 0; i < *count; ++i) {
+            auto delta = read();
+            if (!delta || *delta >= bound)
+                return false;
+            const auto current = i == 0 ? *delta : previous + *delta + 1;
+            if (current >= bound)
+                return false;
+            visitor(current);
+            previous = current;
+        }
+        return true;
+    }
+
+    std::string_view take(size_t size)
+    {
+        auto taken = m_data.substr(0, size);
+        m_data.remove_prefix(taken.size());
+        return taken;
+    }
+
+    bool at_end() const { return m_data.empty(); }
+
+  private:
+    std::string_view m_data;
+};
+
+// The alphabet along with the epsilon transition value, in the order transitions are sorted by.
+std::string symbols_with_epsilon(const std::set<char> &alphabet)
+{
+    std::set<char> symbols = alphabet;
+    symbols.insert(FiniteAutomaton::epsilon_transition_value);
+    return std::string(symbols.begin(), symbols.end());
+}
+} // namespace
+
+std::string FiniteAutomaton::serialize(bool with_checksum) const
+{
+    std::string data(serialization_magic);
+    data += static_cast<char>(serialization_version);
+    data += static_cast<char>(with_checksum ? checksum_flag : 0);
+
+    append_varint(data, m_alphabet.size());
+    data.append(m_alphabet.begin(), m_alphabet.end());
+
+    const std::vector<unsigned> states(m_states.begin(), m_states.end());
+    // States are mostly numbered densely from 0, in which case they are their own indices.
+    const bool dense = states.empty() || states.back() == states.size() - 1;
+    const auto state_index = [&](unsigned state) -> std::uint64_t {
+        return dense ? state : std::ranges::lower_bound(states, state) - states.begin();
+    };
+    append_increasing(data, states, std::identity{});
+    append_increasing(data, m_initial_states, state_index);
+    append_increasing(data, m_final_states, state_index);
+
+    const auto symbols = symbols_with_epsilon(m_alphabet);
+    std::array<std::uint8_t, 256> symbol_indices{};
+    for (size_t i = 0; i < symbols.size(); ++i)
+        symbol_indices[static_cast<unsigned char>(symbols[i])] = i;
+
+    // The transitions are sorted by their state first, so each row is a contiguous range.
+    auto it = m_transition_function.begin();
+    for (const auto &state : states) {
+        const auto row_end = std::find_if(it, m_transition_function.end(), [&](const auto &transition) {
+            return transition.first.first != state;
+        });
+        std::vector<char> row_symbols;
+        for (auto row_it = it; row_it != row_end; ++row_it)
+            row_symbols.push_back(row_it->first.second);
+        append_increasing(data, row_symbols, [&](char symbol) {
+            return symbol_indices[static_cast<unsigned char>(symbol)];
+        });
+        for (; it != row_end; ++it)
+            append_increasing(data, it->second, state_index);
+    }
+
+    if (with_checksum) {
+        auto hash = checksum(data);
+        for (unsigned i = 0; i < sizeof(hash); ++i, hash >>= 8)
+            data += static_cast<char>(hash & 0xff);
+    }
+
+    return data;
+}
+
+std::expected<FiniteAutomaton, std::string> FiniteAutomaton::deserialize(std::string_view data)
+{
+    const auto format_error = std::unexpected("Automaton data is truncated or corrupt");
+
+    if (!data.starts_with(serialization_magic) || data.size() < serialization_magic.size() + 2)
+        return std::unexpected("Unknown automaton format");
+    if (static_cast<std::uint8_t>(data[serialization_magic.size()]) != serialization_version)
+        return std::unexpected("Unsupported automaton format version");
+
+    if (data[serialization_magic.size() + 1] & checksum_flag) {
+        std::uint64_t hash = 0;
+        if (data.size() < serialization_magic.size() + 2 + sizeof(hash))
+            return format_error;
+        for (unsigned i = 0; i < sizeof(hash); ++i)
+            hash |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[data.size() - 1 - i])) << (56 - 8 * i);
+        data.remove_suffix(sizeof(hash));
+        if (checksum(data) != hash)
+            return std::unexpected("Automaton checksum mismatch");
+    }
+
+    VarintReader in(data.substr(serialization_magic.size() + 2));
+
+    // Everything is validated while reading, in a single pass, and the sets are built in increasing order.
+    std::set<char> alphabet;
+    auto alphabet_size = in.read_count();
+    if (!alphabet_size)
+        return format_error;
+    for (const auto &symbol : in.take(*alphabet_size)) {
+        if (symbol == epsilon_transition_value || (!alphabet.empty() && symbol <= *alphabet.rbegin()))
+            return format_error;
+        alphabet.insert(alphabet.end(), symbol);
+    }
+
+    std::vector<unsigned> states;
+    std::set<unsigned> state_set, initial_states, final_states;
+    constexpr std::uint64_t state_bound = std::uint64_t(std::numeric_limits<unsigned>::max()) + 1;
+    if (!in.read_increasing(state_bound, [&](std::uint64_t state) { states.push_back(state); }))
+        return format_error;
+    state_set.insert(states.begin(), states.end());
+    if (!in.read_increasing(states.size(), [&](auto i) { initial_states.insert(initial_states.end(), states[i]); })
+        || !in.read_increasing(states.size(), [&](auto i) { final_states.insert(final_states.end(), states[i]); }))
+        return format_error;
+
+    const auto symbols = symbols_with_epsilon(alphabet);
+    std::map<std::pair<unsigned, char>, std::set<unsigned>> transition_function;
+    for (const auto &state : states) {
+        std::vector<char> row_symbols;
+        if (!in.read_increasing(symbols.size(), [&](auto i) { row_symbols.push_back(symbols[i]); }))
+            return format_error;
+        for (const auto &symbol : row_symbols) {
+            auto &to_states = transition_function.emplace_hint(transition_function.end(), std::pair{state, symbol},
+                                                               std::set<unsigned>{})->second;
+            if (!in.read_increasing(states.size(), [&](auto i) { to_states.insert(to_states.end(), states[i]); }))
+                return format_error;
+        }
+    }
+
+    if (!in.at_end())
+        return format_error;
+
+    return FiniteAutomaton(
+        std::move(alphabet), std::move(state_set), std::move(initial_states), std::move(final_states),
+        std::move(transition_function));
+}
+
+bool FiniteAutomaton::operator==(const FiniteAutomaton &other) const
+{
+    const auto &minimal = minimal_form(), &other_minimal = other.minimal_form();
+    return minimal.m_states.size() == other_minimal.m_states.size()
+           && minimal.m_final_states == other_minimal.m_final_states
+           && minimal.m_transition_function == other_minimal.m_transition_function;
+}
+
+std::size_t FiniteAutomaton::canonical_hash() const
+{
+    std::call_once(properties().canonical_hash_known, [this]() {
+        const auto &minimal = minimal_form();
+
+        // The same parts as operator== compares, as varints, which the checksum of serialize is then taken of.
+        std::string data;
+        append_varint(data, minimal.m_states.size());
+        append_increasing(data, minimal.m_final_states, std::identity{});
+        for (const auto &[k, v] : minimal.m_transition_function) {
+            append_varint(data, k.first);
+            data += k.second;
+            append_varint(data, *v.begin());
+        }
+        properties().canonical_hash = checksum(data);
+    });
+    return properties().canonical_hash;
+}
 
 const std::set<char> &FiniteAutomaton::get_alphabet() const { return m_alphabet; }
 
@@ -473,12 +1419,43 @@ const std::map<std::pair<unsigned, char>, std::set<unsigned>> &FiniteAutomaton::
 }
 
 FiniteAutomaton::FiniteAutomaton(
-    const std::set<char> &alphabet, const std::set<unsigned> &states, const std::set<unsigned> &initial_states,
-    const std::set<unsigned> &final_states,
-    const std::map<std::pair<unsigned, char>, std::set<unsigned>> &transition_function)
-    : m_alphabet(alphabet), m_states(states), m_initial_states(initial_states), m_final_states(final_states),
-      m_transition_function(transition_function)
+    std::set<char> alphabet, std::set<unsigned> states, std::set<unsigned> initial_states,
+    std::set<unsigned> final_states, std::map<std::pair<unsigned, char>, std::set<unsigned>> transition_function)
+    : m_alphabet(std::move(alphabet)), m_states(std::move(states)), m_initial_states(std::move(initial_states)),
+      m_final_states(std::move(final_states)), m_transition_function(std::move(transition_function)),
+      m_properties(std::make_shared<Properties>())
+{
+}
+
+const FiniteAutomaton::Properties &FiniteAutomaton::classify() const
+{
+    auto &properties = this->properties();
+    std::call_once(properties.classified, [&]() {
+        properties.epsilon_free = true;
+        properties.deterministic = m_initial_states.size() == 1;
+
+        size_t num_of_transitions = 0;
+        for (const auto &[k, v] : m_transition_function) {
+            if (v.empty())
+                continue;
+            if (k.second == epsilon_transition_value) {
+                properties.epsilon_free = properties.deterministic = false;
+                continue;
+            }
+            if (v.size() > 1)
+                properties.deterministic = false;
+            ++num_of_transitions;
+        }
+        properties.complete = num_of_transitions == m_states.size() * m_alphabet.size();
+    });
+    return properties;
+}
+
+FiniteAutomaton::Properties &FiniteAutomaton::properties() const
 {
+    if (!m_properties)
+        m_properties = std::make_shared<Properties>();
+    return *m_properties;
 }
 
 std::set<unsigned> FiniteAutomaton::epsilon_closure(const std::set<unsigned> &from_states) const
@@ -508,47 +1485,83 @@ std::set<unsigned> FiniteAutomaton::epsilon_closure(const std::set<unsigned> &fr
     return closure;
 }
 
+std::map<std::pair<unsigned, char>, std::set<unsigned>> FiniteAutomaton::reverse_transition_function() const
+{
+    std::map<std::pair<unsigned, char>, std::set<unsigned>> reverse_transition_function;
+
+    // The incoming transitions of each state are sorted by symbol and then by source, so the
+    // reversed transitions are all appended in order.
+    const TransitionGraph graph(*this);
+    for (unsigned state = 0; state < graph.get_num_of_states(); ++state) {
+        for (const auto &[symbol, from_state] : graph.predecessors(state)) {
+            const std::pair key = {graph.get_original_state(state), symbol};
+            auto it = reverse_transition_function.emplace_hint(
+                reverse_transition_function.end(), key, std::set<unsigned>{});
+            it->second.insert(it->second.end(), graph.get_original_state(from_state));
+        }
+    }
+
+    return reverse_transition_function;
+}
+
 FiniteAutomaton FiniteAutomaton::product_operation(const FiniteAutomaton &other, const auto &operation) const
 {
     std::set<char> alphabet_union;
     std::ranges::set_union(m_alphabet, other.m_alphabet, std::inserter(alphabet_union, alphabet_union.end()));
 
-    const auto automaton_a =
-        FiniteAutomaton(alphabet_union, m_states, m_initial_states, m_final_states, m_transition_function)
-            .determinize()
-            .complete();
-    const auto automaton_b =
-        FiniteAutomaton(
-            alphabet_union, other.m_states, other.m_initial_states, other.m_final_states, other.m_transition_function)
-            .determinize()
-            .complete();
+    // Neither automaton is completed: a missing transition leads to an implicit sink, numbered right after
+    // the states (determinize numbers the states densely).
+    const auto automaton_a = determinize(), automaton_b = other.determinize();
+    const unsigned sink_a = automaton_a.m_states.size(), sink_b = automaton_b.m_states.size();
+    const TransitionGraph graph_a(automaton_a), graph_b(automaton_b);
+    const auto successors = [](const TransitionGraph &graph, unsigned state, unsigned sink) {
+        return state == sink ? std::span<const TransitionGraph::Edge>() : graph.successors(state);
+    };
 
-    // Note: In order for the product numbering to work, the states of each automaton must form a continuous
-    // sequence. Luckily, that is already guaranteed with the FiniteAutomaton::determinize() method.
-    const unsigned num_of_states_b = automaton_b.m_states.size();
+    // Only the pairs reachable from the initial pair are built, numbered in breadth-first order. They are looked
+    // up by both states packed into one key, as a table of all pairs would grow with the product of the sizes.
+    std::unordered_map<std::uint64_t, unsigned> pair_ids;
+    std::vector<std::pair<unsigned, unsigned>> pairs;
+    const auto pair_id = [&](unsigned state_a, unsigned state_b) {
+        const auto [it, inserted] = pair_ids.try_emplace(std::uint64_t(state_a) << 32 | state_b, pairs.size());
+        if (inserted)
+            pairs.push_back({state_a, state_b});
+        return it->second;
+    };
+    pair_id(*automaton_a.m_initial_states.begin(), *automaton_b.m_initial_states.begin());
 
-    std::set<unsigned> product_states, product_initial_states, product_final_states;
+    std::set<unsigned> product_states, product_final_states;
     std::map<std::pair<unsigned, char>, std::set<unsigned>> product_transition_function;
 
-    for (const auto &state_a : automaton_a.m_states) {
-        for (const auto &state_b : automaton_b.m_states) {
-            const unsigned from_state = num_of_states_b * state_a + state_b;
-
-            product_states.insert(from_state);
-            if (automaton_a.m_initial_states.contains(state_a) && automaton_b.m_initial_states.contains(state_b))
-                product_initial_states.insert(from_state);
-            if (operation(automaton_a.m_final_states.contains(state_a), automaton_b.m_final_states.contains(state_b)))
-                product_final_states.insert(from_state);
-
-            for (const auto &symbol : alphabet_union) {
-                const auto state_a_to = *automaton_a.m_transition_function.find({state_a, symbol})->second.begin();
-                const auto state_b_to = *automaton_b.m_transition_function.find({state_b, symbol})->second.begin();
-                const unsigned to_state = num_of_states_b * state_a_to + state_b_to;
-                product_transition_function[{from_state, symbol}].insert(to_state);
-            }
+    // The pairs are visited in the order of their numbers, so everything is appended.
+    for (unsigned from_state = 0; from_state < pairs.size(); ++from_state) {
+        const auto [state_a, state_b] = pairs[from_state];
+        product_states.insert(product_states.end(), from_state);
+        if (operation(automaton_a.m_final_states.contains(state_a), automaton_b.m_final_states.contains(state_b)))
+            product_final_states.insert(product_final_states.end(), from_state);
+
+        // The rows are sorted by symbol, so they are walked along the alphabet. The pair of both sinks is left
+        // implicit as well, since no operation accepts where neither automaton does.
+        const auto edges_a = successors(graph_a, state_a, sink_a), edges_b = successors(graph_b, state_b, sink_b);
+        size_t i_a = 0, i_b = 0;
+        for (const auto &symbol : alphabet_union) {
+            const auto to_state_a =
+                i_a < edges_a.size() && edges_a[i_a].symbol == symbol ? edges_a[i_a++].state : sink_a;
+            const auto to_state_b =
+                i_b < edges_b.size() && edges_b[i_b].symbol == symbol ? edges_b[i_b++].state : sink_b;
+            if (to_state_a == sink_a && to_state_b == sink_b)
+                continue;
+            product_transition_function.emplace_hint(
+                product_transition_function.end(), std::pair{from_state, symbol},
+                std::set<unsigned>{pair_id(to_state_a, to_state_b)});
         }
     }
 
+    // The pairs which can't lead to a final state are trimmed.
     return FiniteAutomaton(
-        alphabet_union, product_states, product_initial_states, product_final_states, product_transition_function);
+               std::move(alphabet_union), std::move(product_states), {0}, std::move(product_final_states),
+               std::move(product_transition_function))
+        .trim()
+        .renumber_states()
+        .first;
 }
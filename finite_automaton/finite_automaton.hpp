@@ -1,42 +1,115 @@
 #ifndef FINITE_AUTOMATON_HPP
 #define FINITE_AUTOMATON_HPP
 
+#include "regex_dag.hpp"
+
+#include <cstdint>
 #include <expected>
+#include <functional>
 #include <map>
+#include <memory>
 #include <optional>
 #include <set>
+#include <span>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+class WordEnumerator;
+
 class FiniteAutomaton
 {
+    // Needed for tagging the states of the determinized pattern union.
+    friend class MultiPatternMatcher;
+
   public:
     inline static const char epsilon_transition_value = '~';
 
+    // The containers are taken by value, so that temporaries are moved into the automaton instead of copied.
     static std::expected<FiniteAutomaton, std::string> construct(
-        const std::set<char> &alphabet, const std::set<unsigned> &states, const std::set<unsigned> &initial_states,
-        const std::set<unsigned> &final_states,
-        const std::map<std::pair<unsigned, char>, std::set<unsigned>> &transition_function);
+        std::set<char> alphabet, std::set<unsigned> states, std::set<unsigned> initial_states,
+        std::set<unsigned> final_states, std::map<std::pair<unsigned, char>, std::set<unsigned>> transition_function);
 
     static std::expected<FiniteAutomaton, std::string> construct(const std::string &regex);
+    // Disjoint union of the automata of the given regexes, in which the
+    // i-th smallest final state is the single final state of the i-th regex.
+    static std::expected<FiniteAutomaton, std::string> construct(std::span<const std::string> regexes);
+
+    // Reads an automaton from a line-based format, meant for large generated automata, with lines of the forms:
+    //   <state> <symbol> <state>    a transition, by the epsilon transition value for epsilon transitions
+    //   initial <state>...
+    //   final <state>...
+    //   states <state>...           states which no other line mentions
+    //   alphabet <symbol>...        symbols which no transition is by
+    // Empty lines and lines starting with '#' are skipped.
+    static std::expected<FiniteAutomaton, std::string> from_text(std::string_view text);
 
     bool accepts(const std::string &word) const;
+    // Whether each word is accepted, written to the result of the same index (there must be at least as many
+    // results as words). The automaton is compiled only once and the words are split between threads.
+    void accepts_all(std::span<const std::string_view> words, std::span<bool> results) const;
     std::vector<std::set<unsigned>> generate_match_steps(const std::string &word) const;
 
+    // Automata which determinize built are returned as they are.
     FiniteAutomaton determinize() const;
+    // A missing transition leads to an implicit dead state, so the operations don't need complete automata; the
+    // dead state is only materialized here, and in complement, where it becomes final.
     FiniteAutomaton complete() const;
     FiniteAutomaton reverse() const;
+    // The minimal form is computed only once, and is shared by the copies of the automaton.
     FiniteAutomaton minimize() const;
     FiniteAutomaton complement() const;
+    // Removes the states which can't be reached from an initial state or can't lead to a final state, keeping the
+    // numbers of the other states. Without any such states left, the initial states are kept on their own.
+    FiniteAutomaton trim() const;
+    // The automaton with its states numbered densely from 0, in increasing order, along with the original state
+    // each new one stands for. Per-state data of such an automaton can be kept in vectors indexed by state.
+    std::pair<FiniteAutomaton, std::vector<unsigned>> renumber_states() const &;
+    std::pair<FiniteAutomaton, std::vector<unsigned>> renumber_states() &&;
+    // Whether the states are 0..n-1, which the automata built by construct(regex), determinize, complete
+    // (of a dense automaton) and the product operations always are.
+    bool has_dense_states() const;
+
+    // Derived properties, each computed the first time it is asked for and kept along with the automaton, so that
+    // the operations can skip the passes that wouldn't change anything.
+    bool is_epsilon_free() const;
+    bool is_deterministic() const;
+    // Whether every state has a transition by every symbol of the alphabet.
+    bool is_complete() const;
+    // Whether trim would leave the automaton as it is.
+    bool is_trimmed() const;
+    // Whether the automaton is a DFA with as many states as its minimal form, which has no dead state.
+    bool is_minimal() const;
 
     FiniteAutomaton union_with(const FiniteAutomaton &other) const;
     FiniteAutomaton intersection_with(const FiniteAutomaton &other) const;
     FiniteAutomaton difference_with(const FiniteAutomaton &other) const;
 
     std::optional<std::string> generate_regex() const;
+    std::optional<RegexDag> generate_regex_dag() const;
     std::optional<std::string> generate_valid_word() const;
     std::optional<std::string> generate_invalid_word() const;
+    // Defined in word_enumerator.hpp, which has to be included to use the range.
+    WordEnumerator enumerate_words(unsigned max_length) const;
+
+    bool is_finite() const;
+    // The counts saturate at the maximum value of std::uint64_t. The lengths up to the number of states take
+    // a step each, longer ones a number of steps cubic in the number of states but logarithmic in the length.
+    std::uint64_t count_words(unsigned length) const;
+    std::uint64_t count_words_up_to(unsigned length) const;
+
+    // Compact, versioned binary form, optionally checksummed, in which the transitions are stored as rows per
+    // state, of delta-encoded varints. It can be read straight from a buffer, e.g. of a memory-mapped file.
+    std::string serialize(bool with_checksum = true) const;
+    static std::expected<FiniteAutomaton, std::string> deserialize(std::string_view data);
+
+    // Whether both automata accept the same words, which their minimal forms tell: the subset construction numbers
+    // the states canonically, in breadth-first order from the initial state, following the symbols in order. The
+    // alphabets themselves aren't compared.
+    bool operator==(const FiniteAutomaton &other) const;
+    // Hash of the canonical minimal form, which agrees with operator==, for looking automata up by their language.
+    std::size_t canonical_hash() const;
 
     const std::set<char> &get_alphabet() const;
     const std::set<unsigned> &get_states() const;
@@ -45,19 +118,43 @@ class FiniteAutomaton
     const std::map<std::pair<unsigned, char>, std::set<unsigned>> &get_transition_function() const;
 
   private:
+    // For automata built internally, which are valid by construction, so none of the checks of construct are
+    // done. The containers are moved in.
     FiniteAutomaton(
-        const std::set<char> &alphabet, const std::set<unsigned> &states, const std::set<unsigned> &initial_states,
-        const std::set<unsigned> &final_states,
-        const std::map<std::pair<unsigned, char>, std::set<unsigned>> &transition_function);
+        std::set<char> alphabet, std::set<unsigned> states, std::set<unsigned> initial_states,
+        std::set<unsigned> final_states, std::map<std::pair<unsigned, char>, std::set<unsigned>> transition_function);
 
+    // Also returns the subset of the starting states each determinized state stands for.
+    std::pair<FiniteAutomaton, std::vector<std::set<unsigned>>> determinize_with_subsets() const;
     std::set<unsigned> epsilon_closure(const std::set<unsigned> &from_states) const;
+    std::map<std::pair<unsigned, char>, std::set<unsigned>> reverse_transition_function() const;
+    // As complete and reverse, reusing the containers of the automaton, for temporaries in chains of operations.
+    // They aren't overloads of those, so that their member pointers stay unambiguous.
+    FiniteAutomaton into_complete() &&;
+    FiniteAutomaton into_reverse() &&;
     FiniteAutomaton product_operation(const FiniteAutomaton &other, const auto &operation) const;
 
+    // The cache of the derived properties. An automaton doesn't change once it's built, so copies share it, and
+    // the few private functions which modify an automaton in place start a new one. Moving an automaton takes
+    // its cache along, and the moved-from automaton gets a new one once it's asked for (as any other use of a
+    // moved-from object, that mustn't happen from several threads at once).
+    struct Properties;
+    Properties &properties() const;
+    const Properties &classify() const;
+    const FiniteAutomaton &minimal_form() const;
+
     std::set<char> m_alphabet;
     std::set<unsigned> m_states;
     std::set<unsigned> m_initial_states;
     std::set<unsigned> m_final_states;
     std::map<std::pair<unsigned, char>, std::set<unsigned>> m_transition_function;
+
+    mutable std::shared_ptr<Properties> m_properties;
+};
+
+template <> struct std::hash<FiniteAutomaton>
+{
+    std::size_t operator()(const FiniteAutomaton &automaton) const { return automaton.canonical_hash(); }
 };
 
 #endif // FINITE_AUTOMATON_HPP
@@ -1,7 +1,24 @@
+#include "cpp_generator.hpp"
+#include "dfa_table.hpp"
 #include "finite_automaton.hpp"
+#include "line_scanner.hpp"
+#include "multi_pattern_matcher.hpp"
+#include "scene_file.hpp"
+#include "searcher.hpp"
+#include "static_regex.hpp"
+#include "stream_matcher.hpp"
+#include "threaded_matcher.hpp"
+#include "transition_graph.hpp"
+#include "word_enumerator.hpp"
+#include "word_sampler.hpp"
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+
 TEST(FiniteAutomatonConstruct, ByMember)
 {
     auto eps = FiniteAutomaton::epsilon_transition_value;
@@ -130,6 +147,27 @@ TEST(FiniteAutomatonConstruct, RegexComplex)
     EXPECT_FALSE(fa.value().accepts("bbbbbbbbbb"));
 }
 
+TEST(FiniteAutomatonConstruct, RegexConcurrent)
+{
+    // Every thread parses with a scanner of its own.
+    std::vector<char> results(8, false);
+    {
+        std::vector<std::jthread> threads;
+        for (size_t i = 0; i < results.size(); ++i) {
+            threads.emplace_back([&results, i]() {
+                bool all_accepted = true;
+                for (unsigned j = 0; j < 200; ++j) {
+                    const std::string word(i + 1, 'a' + i);
+                    auto fa = FiniteAutomaton::construct("(" + word + ")+|x*" + std::string(j % 5, 'y'));
+                    all_accepted = all_accepted && fa && fa->accepts(word + word);
+                }
+                results[i] = all_accepted;
+            });
+        }
+    }
+    EXPECT_TRUE(std::ranges::all_of(results, [](char result) { return result; }));
+}
+
 TEST(FiniteAutomatonConstruct, RegexInvalid)
 {
     EXPECT_FALSE(FiniteAutomaton::construct("")) << "Empty string is not a valid regex";
@@ -188,6 +226,24 @@ TEST_F(FiniteAutomatonTest, Accept)
     EXPECT_FALSE(empty_word->accepts("10101"));
 }
 
+TEST_F(FiniteAutomatonTest, AcceptAll)
+{
+    // Enough words to be split between threads.
+    std::vector<std::string> words;
+    for (unsigned i = 0; i < 10000; ++i) {
+        std::string word;
+        for (unsigned bits = i; bits > 1; bits >>= 1)
+            word += bits & 1 ? 'b' : 'a';
+        words.push_back(word + (i % 7 == 0 ? "x" : ""));
+    }
+    const std::vector<std::string_view> views(words.begin(), words.end());
+
+    auto results = std::make_unique<bool[]>(views.size());
+    ends_with_aab_r->accepts_all(views, {results.get(), views.size()});
+    for (size_t i = 0; i < words.size(); ++i)
+        EXPECT_EQ(results[i], ends_with_aab_r->accepts(words[i])) << words[i];
+}
+
 TEST_F(FiniteAutomatonTest, Determinize)
 {
     auto eps = FiniteAutomaton::epsilon_transition_value;
@@ -237,3 +293,773 @@ TEST_F(FiniteAutomatonTest, Reverse)
     for (const auto &word : {"a", "aaabbb", "bababa"})
         EXPECT_FALSE(rev_even_num_of_a.accepts(word));
 }
+
+TEST_F(FiniteAutomatonTest, Trim)
+{
+    auto eps = FiniteAutomaton::epsilon_transition_value;
+    // State 3 can't be reached, state 4 can't lead to the final state and state 5 is neither.
+    auto fa = FiniteAutomaton::construct(
+        {'a', 'b'}, {0, 1, 2, 3, 4, 5}, {0}, {2},
+        {{{0, 'a'}, {1, 4}}, {{1, eps}, {2}}, {{3, 'b'}, {2}}, {{4, 'b'}, {4}}, {{5, 'a'}, {5}}});
+    ASSERT_TRUE(fa);
+
+    const auto trimmed = fa->trim();
+    EXPECT_EQ(trimmed.get_states(), (std::set<unsigned>{0, 1, 2}));
+    EXPECT_EQ(trimmed.get_transition_function().at({0, 'a'}), std::set<unsigned>{1});
+    EXPECT_EQ(trimmed.get_transition_function().size(), 2);
+    for (const auto &word : {"", "a", "ab", "b"})
+        EXPECT_EQ(trimmed.accepts(word), fa->accepts(word)) << word;
+
+    const auto empty = fa->intersection_with(*ends_with_ab).trim();
+    EXPECT_EQ(empty.get_states(), std::set<unsigned>{0}) << "The initial state of an empty language is kept";
+    EXPECT_TRUE(empty.get_transition_function().empty());
+
+    // The product keeps neither the error states of the complete automata nor the pairs that can't be reached.
+    const auto product = ends_with_ab->intersection_with(*even_num_of_a);
+    EXPECT_EQ(product.get_states().size(), 6);
+    EXPECT_TRUE(product.accepts("aab") && product.accepts("babbab") && !product.accepts("ab"));
+}
+
+TEST(FiniteAutomatonOperations, ImplicitDeadState)
+{
+    // Neither automaton is complete, and neither knows the symbols of the other.
+    auto ab = FiniteAutomaton::construct({'a', 'b'}, {0, 1, 2}, {0}, {2}, {{{0, 'a'}, {1}}, {{1, 'b'}, {2}}});
+    auto cs = FiniteAutomaton::construct({'c'}, {0}, {0}, {0}, {{{0, 'c'}, {0}}});
+    ASSERT_TRUE(ab && cs);
+
+    const auto union_fa = ab->union_with(*cs);
+    const auto difference = cs->difference_with(*ab);
+    for (const auto &word : {"", "ab", "ccc", "abc", "a", "cab"}) {
+        EXPECT_EQ(union_fa.accepts(word), ab->accepts(word) || cs->accepts(word)) << word;
+        EXPECT_EQ(difference.accepts(word), cs->accepts(word) && !ab->accepts(word)) << word;
+    }
+    EXPECT_EQ(union_fa.get_states().size(), 4) << "No dead state is materialized";
+    EXPECT_EQ(ab->complement().get_states().size(), 4);
+    EXPECT_TRUE(ab->complement().accepts("ba"));
+    EXPECT_EQ(ab->generate_valid_word(), "ab");
+}
+
+TEST_F(FiniteAutomatonTest, DerivedProperties)
+{
+    EXPECT_FALSE(ends_with_aab_r->is_epsilon_free() || ends_with_aab_r->is_deterministic());
+    EXPECT_FALSE(ends_with_aab_r->is_minimal());
+
+    const auto dfa = ends_with_aab_r->determinize();
+    EXPECT_TRUE(dfa.is_epsilon_free() && dfa.is_deterministic());
+    EXPECT_EQ(dfa.determinize().get_transition_function(), dfa.get_transition_function());
+
+    // A DFA which determinize didn't build is still determinized, dropping its unreachable state 1.
+    auto unreachable = FiniteAutomaton::construct({'a'}, {0, 1}, {0}, {1}, {{{0, 'a'}, {0}}, {{1, 'a'}, {0}}});
+    ASSERT_TRUE(unreachable && unreachable->is_deterministic());
+    const auto determinized = unreachable->determinize();
+    EXPECT_EQ(determinized.get_states(), std::set<unsigned>{0});
+    EXPECT_TRUE(determinized.get_final_states().empty());
+
+    // The language {ab} needs an error state to be complete.
+    auto ab = FiniteAutomaton::construct({'a', 'b'}, {0, 1, 2}, {0}, {2}, {{{0, 'a'}, {1}}, {{1, 'b'}, {2}}});
+    ASSERT_TRUE(ab);
+    EXPECT_FALSE(ab->is_complete());
+
+    const auto complete = ab->complete();
+    EXPECT_TRUE(complete.is_complete());
+    EXPECT_FALSE(complete.is_trimmed()) << "The error state can't lead to a final state";
+    EXPECT_TRUE(complete.trim().is_trimmed());
+
+    const auto minimal = complete.minimize();
+    EXPECT_TRUE(minimal.is_minimal() && ab->is_minimal());
+    EXPECT_FALSE(complete.is_minimal());
+    EXPECT_EQ(minimal.minimize().get_states(), minimal.get_states());
+    EXPECT_EQ(complete.minimize().get_transition_function(), minimal.get_transition_function());
+
+    // Determinizing the reverse gives back the DFA, with its unreachable state 2, which Brzozowski's minimization
+    // mustn't keep.
+    auto with_unreachable =
+        FiniteAutomaton::construct({'a'}, {0, 1, 2}, {0}, {0, 1}, {{{1, 'a'}, {1}}, {{2, 'a'}, {0}}});
+    ASSERT_TRUE(with_unreachable);
+    EXPECT_EQ(with_unreachable->reverse().minimize().get_states().size(), 1);
+
+    // Modifying a copy in place doesn't change the properties of the original.
+    const auto complement = minimal.complement();
+    EXPECT_FALSE(minimal.is_complete());
+    EXPECT_TRUE(complement.is_complete() && complement.accepts("aab") && !complement.accepts("ab"));
+    EXPECT_TRUE(minimal.accepts("ab"));
+
+    // A moved-from automaton can still be used.
+    auto moved_from = *ab;
+    const auto moved_to = std::move(moved_from);
+    EXPECT_TRUE(moved_to.is_deterministic());
+    auto rebuilt = FiniteAutomaton::construct(
+        moved_from.get_alphabet(), moved_from.get_states(), moved_from.get_initial_states(),
+        moved_from.get_final_states(), moved_from.get_transition_function());
+    ASSERT_TRUE(rebuilt);
+    EXPECT_EQ(moved_from.is_deterministic(), rebuilt->is_deterministic());
+    EXPECT_EQ(moved_from.minimize().get_states(), rebuilt->minimize().get_states());
+    EXPECT_EQ(moved_from.canonical_hash(), rebuilt->canonical_hash());
+    moved_from = *ab;
+    EXPECT_EQ(moved_from, moved_to);
+}
+
+TEST(FiniteAutomatonOperations, Equivalence)
+{
+    // The same language, from differently written regexes and from an automaton with a larger alphabet.
+    auto fa = FiniteAutomaton::construct("(a|b)*");
+    auto other = FiniteAutomaton::construct("(a*b*)*");
+    auto larger_alphabet = FiniteAutomaton::construct(
+        {'a', 'b', 'c'}, {3, 7}, {7}, {3, 7}, {{{7, 'a'}, {3}}, {{7, 'b'}, {7}}, {{3, 'a'}, {7}}, {{3, 'b'}, {3}}});
+    ASSERT_TRUE(fa && other && larger_alphabet);
+    EXPECT_EQ(*fa, *other);
+    EXPECT_EQ(*fa, *larger_alphabet);
+    EXPECT_EQ(fa->canonical_hash(), other->canonical_hash());
+    EXPECT_EQ(fa->canonical_hash(), larger_alphabet->canonical_hash());
+
+    auto plus = FiniteAutomaton::construct("(a|b)+");
+    ASSERT_TRUE(plus);
+    EXPECT_NE(*fa, *plus);
+    EXPECT_NE(fa->canonical_hash(), plus->canonical_hash());
+    EXPECT_EQ(*plus, fa->difference_with(*FiniteAutomaton::construct({}, {0}, {0}, {0}, {})));
+
+    const std::unordered_set<FiniteAutomaton> languages = {*fa, *other, *larger_alphabet, *plus};
+    EXPECT_EQ(languages.size(), 2);
+}
+
+TEST(FiniteAutomatonOperations, RenumberStates)
+{
+    auto sparse = FiniteAutomaton::construct(
+        {'a', 'b'}, {3, 10, 42}, {10}, {42}, {{{10, 'a'}, {3, 42}}, {{3, 'b'}, {10}}, {{42, 'a'}, {42}}});
+    ASSERT_TRUE(sparse);
+    EXPECT_FALSE(sparse->has_dense_states());
+
+    const auto [dense, original_states] = sparse->renumber_states();
+    EXPECT_TRUE(dense.has_dense_states());
+    EXPECT_EQ(original_states, (std::vector<unsigned>{3, 10, 42}));
+    EXPECT_EQ(dense.get_initial_states(), std::set<unsigned>{1});
+    EXPECT_EQ(dense.get_final_states(), std::set<unsigned>{2});
+    EXPECT_EQ(dense.get_transition_function().at({1, 'a'}), (std::set<unsigned>{0, 2}));
+    for (const auto &word : {"a", "aaa", "aba", "abab", ""})
+        EXPECT_EQ(dense.accepts(word), sparse->accepts(word)) << word;
+
+    auto regex = FiniteAutomaton::construct("(a|b)*abb");
+    ASSERT_TRUE(regex);
+    EXPECT_TRUE(regex->has_dense_states());
+    EXPECT_TRUE(sparse->complete().determinize().has_dense_states());
+    EXPECT_TRUE(regex->union_with(*sparse).has_dense_states());
+}
+
+TEST(FiniteAutomatonGenerate, Regex)
+{
+    // Every word over the alphabet up to the given length must be equally accepted by both automata.
+    const auto same_language = [](const FiniteAutomaton &a, const FiniteAutomaton &b, unsigned max_length) {
+        std::vector<std::string> words = {""};
+        for (size_t i = 0; i < words.size(); ++i) {
+            if (a.accepts(words[i]) != b.accepts(words[i]))
+                return false;
+            if (words[i].size() < max_length) {
+                for (const auto &symbol : a.get_alphabet())
+                    words.push_back(words[i] + symbol);
+            }
+        }
+        return true;
+    };
+
+    for (const auto &regex : {"a", "a*", "(ab|b*a+)*", "(a|b)*aab", "a*b+c?(da*)+e", "(a(bc)*d|e)+f*(gh|g)"}) {
+        auto fa = FiniteAutomaton::construct(regex);
+        ASSERT_TRUE(fa);
+
+        auto generated = fa->generate_regex();
+        ASSERT_TRUE(generated);
+        auto generated_fa = FiniteAutomaton::construct(*generated);
+        ASSERT_TRUE(generated_fa) << *generated;
+
+        EXPECT_TRUE(same_language(*fa, *generated_fa, 5)) << regex << " generated as " << *generated;
+    }
+
+    auto chain = FiniteAutomaton::construct("a*bc*de*fg*hi*j");
+    ASSERT_TRUE(chain);
+    EXPECT_LE(chain->generate_regex()->size(), 30) << "A chain of small loops should give a linear-size regex";
+
+    auto empty = FiniteAutomaton::construct({'a'}, {0, 1}, {0}, {1}, {});
+    ASSERT_TRUE(empty);
+    EXPECT_FALSE(empty->generate_regex()) << "No regex describes the empty language";
+}
+
+TEST(FiniteAutomatonGenerate, RegexDag)
+{
+    auto fa = FiniteAutomaton::construct("(a|b)(c|d)(e|f)(g|h)");
+    ASSERT_TRUE(fa);
+
+    auto dag = fa->generate_regex_dag();
+    ASSERT_TRUE(dag);
+    EXPECT_EQ(dag->expand(), *fa->generate_regex()) << "The flat regex is the expansion of the DAG";
+
+    RegexDag built;
+    auto ab = built.alternation(built.symbol('a'), built.symbol('b'));
+    EXPECT_EQ(ab, built.alternation(built.symbol('a'), built.symbol('b'))) << "Equal subexpressions are stored once";
+    auto twice = built.concatenation(built.zero_or_more(ab), built.concatenation(ab, built.zero_or_more(ab)));
+    built.set_root(built.alternation(twice, built.epsilon()));
+
+    EXPECT_EQ(built.expand(), "((a|b)*(a|b)(a|b)*)?");
+    EXPECT_EQ(built.to_definitions(), "r0 = a|b\nr1 = {r0}*\n({r1}{r0}{r1})?");
+}
+
+TEST(FiniteAutomatonGenerate, RegexLongChain)
+{
+    // A chain of concatenations is as deep as it is long, which mustn't take as many stack frames.
+    const unsigned length = 100000;
+    std::set<unsigned> states;
+    std::map<std::pair<unsigned, char>, std::set<unsigned>> transition_function;
+    for (unsigned state = 0; state < length; ++state) {
+        states.insert(state);
+        transition_function[{state, state % 2 ? 'b' : 'a'}] = {state + 1};
+    }
+    states.insert(length);
+    auto chain = FiniteAutomaton::construct({'a', 'b'}, states, {0}, {length}, transition_function);
+    ASSERT_TRUE(chain);
+
+    auto dag = chain->generate_regex_dag();
+    ASSERT_TRUE(dag);
+    std::string expected;
+    for (unsigned i = 0; i < length / 2; ++i)
+        expected += "ab";
+    EXPECT_EQ(dag->expand(), expected);
+    EXPECT_EQ(dag->to_definitions(), expected);
+
+    RegexDag imported;
+    imported.set_root(imported.import(*dag, dag->get_root()));
+    EXPECT_EQ(imported.expand(), expected);
+}
+
+TEST(FiniteAutomatonSerialize, RoundTrip)
+{
+    auto eps = FiniteAutomaton::epsilon_transition_value;
+    auto fa = FiniteAutomaton::construct(
+        {'a', 'b', '~' + 1, -5}, {3, 7, 1000, 4000000000}, {3, 4000000000}, {7},
+        {{{3, 'a'}, {7, 1000}}, {{3, eps}, {4000000000}}, {{1000, -5}, {3}}, {{4000000000, 'b'}, {}}});
+    ASSERT_TRUE(fa);
+
+    for (bool with_checksum : {true, false}) {
+        const auto data = fa->serialize(with_checksum);
+        auto read_fa = FiniteAutomaton::deserialize(data);
+        ASSERT_TRUE(read_fa) << read_fa.error();
+        EXPECT_EQ(read_fa->get_alphabet(), fa->get_alphabet());
+        EXPECT_EQ(read_fa->get_states(), fa->get_states());
+        EXPECT_EQ(read_fa->get_initial_states(), fa->get_initial_states());
+        EXPECT_EQ(read_fa->get_final_states(), fa->get_final_states());
+        EXPECT_EQ(read_fa->get_transition_function(), fa->get_transition_function());
+
+        EXPECT_FALSE(FiniteAutomaton::deserialize(data.substr(0, data.size() - 1)));
+    }
+
+    auto data = fa->serialize();
+    data[data.size() / 2] ^= 1;
+    EXPECT_FALSE(FiniteAutomaton::deserialize(data)) << "Corruption must be caught by the checksum";
+    EXPECT_FALSE(FiniteAutomaton::deserialize("FATA\x02"));
+    EXPECT_FALSE(FiniteAutomaton::deserialize(""));
+}
+
+TEST(FiniteAutomatonConstruct, FromText)
+{
+    auto fa = FiniteAutomaton::from_text("# Ends with ab\n"
+                                         "initial 0\n"
+                                         "final\t2\r\n"
+                                         "\n"
+                                         "0 a 0\n0 b 0\n0 a 1\n1 b 2\n"
+                                         "2 ~ 2\n"
+                                         "states 7\n"
+                                         "alphabet c\n");
+    ASSERT_TRUE(fa) << fa.error();
+    EXPECT_EQ(fa->get_alphabet(), std::set<char>({'a', 'b', 'c'}));
+    EXPECT_EQ(fa->get_states(), std::set<unsigned>({0, 1, 2, 7}));
+    EXPECT_EQ(fa->get_initial_states(), std::set<unsigned>({0}));
+    EXPECT_EQ(fa->get_final_states(), std::set<unsigned>({2}));
+    EXPECT_EQ(fa->get_transition_function().at({0, 'a'}), std::set<unsigned>({0, 1}));
+    EXPECT_TRUE(fa->accepts("abab"));
+    EXPECT_FALSE(fa->accepts("aba"));
+
+    EXPECT_EQ(FiniteAutomaton::from_text("initial 0\n0 ab 1\n").error(), "Invalid transition on line 2");
+    EXPECT_FALSE(FiniteAutomaton::from_text("0 a -1"));
+    EXPECT_FALSE(FiniteAutomaton::from_text("0 a 1 2"));
+    EXPECT_FALSE(FiniteAutomaton::from_text("final 1x"));
+    EXPECT_FALSE(FiniteAutomaton::from_text("alphabet ~"));
+    EXPECT_FALSE(FiniteAutomaton::from_text("start 0"));
+}
+
+TEST(TransitionGraph, Edges)
+{
+    auto eps = FiniteAutomaton::epsilon_transition_value;
+    auto fa = FiniteAutomaton::construct(
+        {'a', 'b'}, {3, 10, 42}, {10}, {42},
+        {{{10, 'b'}, {3}}, {{10, 'a'}, {3, 42}}, {{3, eps}, {10}}, {{42, 'a'}, {42}}});
+    ASSERT_TRUE(fa);
+    const TransitionGraph graph(*fa);
+
+    ASSERT_EQ(graph.get_num_of_states(), 3);
+    EXPECT_EQ(graph.get_original_state(2), 42);
+    EXPECT_EQ(graph.get_state(10), 1);
+    EXPECT_FALSE(graph.get_state(11));
+
+    const auto to_pairs = [](std::span<const TransitionGraph::Edge> edges) {
+        std::vector<std::pair<char, unsigned>> pairs;
+        for (const auto &[symbol, state] : edges)
+            pairs.push_back({symbol, state});
+        return pairs;
+    };
+    using pairs_t = std::vector<std::pair<char, unsigned>>;
+    EXPECT_EQ(to_pairs(graph.successors(1)), (pairs_t{{'a', 0}, {'a', 2}, {'b', 0}}));
+    EXPECT_EQ(to_pairs(graph.successors(0)), (pairs_t{{eps, 1}}));
+    EXPECT_EQ(to_pairs(graph.predecessors(0)), (pairs_t{{'a', 1}, {'b', 1}}));
+    EXPECT_EQ(to_pairs(graph.predecessors(2)), (pairs_t{{'a', 1}, {'a', 2}}));
+    EXPECT_EQ(graph.next(1, 'b'), 0);
+    EXPECT_FALSE(graph.next(2, 'b'));
+}
+
+TEST(DfaTable, Accept)
+{
+    auto fa = FiniteAutomaton::construct("(ab|b*a+)*c");
+    ASSERT_TRUE(fa);
+    DfaTable table(*fa);
+
+    for (const auto &word : {"c", "abc", "baaabc", "ababaaaaac"})
+        EXPECT_TRUE(table.accepts(word));
+
+    for (const auto &word : {"", "ab", "abbc", "cc", "a~c", "xyz"})
+        EXPECT_FALSE(table.accepts(word));
+
+    EXPECT_EQ(table.get_class('x'), 0) << "Symbols outside of the alphabet belong to the dead class";
+    EXPECT_EQ(table.next(table.get_initial_state(), 'x'), table.get_dead_state());
+
+    auto empty = FiniteAutomaton::construct({'a'}, {0, 1}, {0}, {1}, {{{0, 'a'}, {0}}});
+    ASSERT_TRUE(empty);
+    DfaTable empty_table(*empty);
+    EXPECT_EQ(empty_table.get_num_of_states(), 1) << "States that can't lead to a final state are merged as dead";
+    EXPECT_EQ(empty_table.get_initial_state(), empty_table.get_dead_state());
+}
+
+TEST(DfaTable, AcceptAll)
+{
+    auto fa = FiniteAutomaton::construct("(ab|b*a+)*c");
+    ASSERT_TRUE(fa);
+    DfaTable table(*fa);
+
+    // Words of all kinds of lengths, from empty ones to ones far longer than the rest, so that the lanes end their
+    // words and take the next ones at different times, and some lanes are still busy when the words run out.
+    std::vector<std::string> words = {"", "c", "x", "abc", "abbc", "ababaaaaac", "cc", "a~c"};
+    for (unsigned i = 0; i < 100; ++i)
+        words.push_back(std::string(i % 13, 'a') + std::string(i % 3, 'b') + (i % 5 == 0 ? "" : "ac"));
+    for (unsigned i = 0; i < 20; ++i)
+        words.push_back(std::string(i * 7, i % 2 ? 'a' : 'b') + (i % 4 ? "c" : "") + std::string(i % 3, ' '));
+
+    for (size_t count : {words.size(), size_t(5), size_t(0)}) {
+        const std::vector<std::string_view> views(words.begin(), words.begin() + count);
+        auto results = std::make_unique<bool[]>(count);
+        table.accepts_all(views, {results.get(), count});
+
+        for (size_t i = 0; i < count; ++i)
+            EXPECT_EQ(results[i], table.accepts(words[i])) << words[i];
+    }
+}
+
+TEST(ThreadedMatcher, Accept)
+{
+    // Automata of each kind of state: single symbols in a chain, self-loops on one symbol, all symbols but
+    // one (looping or not) and full rows, along with the empty language and the empty word.
+    for (const auto &regex : {"abc", "ab*", "q(a|b)*q", "x(a|b|c)y(a|b)", "(ab|b*a+)*c", "(a|b)*abb", "a~|~"}) {
+        auto fa = FiniteAutomaton::construct(regex);
+        ASSERT_TRUE(fa);
+        ThreadedMatcher matcher(*fa);
+
+        std::vector<std::string> words = {""};
+        for (size_t i = 0; i < words.size(); ++i) {
+            EXPECT_EQ(matcher.accepts(words[i]), fa->accepts(words[i])) << regex << ": " << words[i];
+            if (words[i].size() < 5) {
+                for (const auto &symbol : {'a', 'b', 'c', 'q', 'x', 'y', '-'})
+                    words.push_back(words[i] + symbol);
+            }
+        }
+    }
+
+    auto empty = FiniteAutomaton::construct({'a'}, {0, 1}, {0}, {1}, {{{0, 'a'}, {0}}});
+    ASSERT_TRUE(empty);
+    ThreadedMatcher empty_matcher(*empty);
+    EXPECT_FALSE(empty_matcher.accepts(""));
+    EXPECT_FALSE(empty_matcher.accepts("aa"));
+}
+
+TEST(StaticRegex, Accept)
+{
+    using regex = fat::static_regex<"(ab|b*a+)*c">;
+    static_assert(regex::accepts("abc") && regex::accepts("baaabc"));
+    static_assert(!regex::accepts("") && !regex::accepts("a~c"));
+    static_assert(regex::num_of_states == 5, "The automaton is minimal, with a dead state");
+
+    static_assert(!fat::detail::compile("").valid);
+    static_assert(!fat::detail::compile("()").valid);
+    static_assert(!fat::detail::compile("a+?*").valid);
+    static_assert(!fat::detail::compile("a|").valid);
+    static_assert(!fat::detail::compile("(a").valid && !fat::detail::compile("a)").valid);
+
+    auto fa = FiniteAutomaton::construct(std::string(regex::pattern));
+    ASSERT_TRUE(fa);
+    auto epsilon = FiniteAutomaton::construct("a(~|b)*");
+    ASSERT_TRUE(epsilon);
+
+    // Every word over the alphabet and a foreign symbol, up to length 6.
+    std::vector<std::string> words = {""};
+    for (size_t i = 0; i < words.size(); ++i) {
+        EXPECT_EQ(regex::accepts(words[i]), fa->accepts(words[i])) << words[i];
+        EXPECT_EQ(fat::static_regex<"a(~|b)*">::accepts(words[i]), epsilon->accepts(words[i])) << words[i];
+        if (words[i].size() < 6) {
+            for (const auto &symbol : {'a', 'b', 'c', 'x'})
+                words.push_back(words[i] + symbol);
+        }
+    }
+}
+
+TEST(CppGenerator, Generate)
+{
+    auto fa = FiniteAutomaton::construct("(ab|b*a+)*c");
+    ASSERT_TRUE(fa);
+
+    EXPECT_FALSE(CppGenerator::generate_function(*fa, "", CppGenerator::Style::Table));
+    EXPECT_FALSE(CppGenerator::generate_function(*fa, "0abc", CppGenerator::Style::Table));
+    EXPECT_FALSE(CppGenerator::generate_function(*fa, "a-b", CppGenerator::Style::Switch));
+    EXPECT_EQ(CppGenerator::to_identifier("1-ids"), "match_1_ids");
+
+    auto table = CppGenerator::generate_function(*fa, "match_table", CppGenerator::Style::Table);
+    ASSERT_TRUE(table);
+    EXPECT_TRUE(table->contains("inline bool match_table(std::string_view word) noexcept"));
+    EXPECT_TRUE(table->contains("transitions[5][4]")) << "The table is of the minimal DFA, with symbol classes";
+
+    auto switch_based = CppGenerator::generate_function(*fa, "match_switch", CppGenerator::Style::Switch);
+    ASSERT_TRUE(switch_based);
+    EXPECT_TRUE(switch_based->contains("case 'c':"));
+    EXPECT_FALSE(switch_based->contains("state_4")) << "The dead state is left to the default case";
+
+    auto quote = FiniteAutomaton::construct("'\\");
+    ASSERT_TRUE(quote);
+    auto escaped = CppGenerator::generate_function(*quote, "match_quote", CppGenerator::Style::Switch);
+    ASSERT_TRUE(escaped);
+    EXPECT_TRUE(escaped->contains("case '\\'':") && escaped->contains("case '\\\\':"));
+
+    const std::vector<std::string> functions = {*table, *switch_based};
+    const auto header = CppGenerator::generate_header(functions);
+    EXPECT_TRUE(header.contains("#include <string_view>"));
+    EXPECT_TRUE(header.contains(*table) && header.contains(*switch_based));
+}
+
+TEST(WordSampler, ShortestWord)
+{
+    auto fa = FiniteAutomaton::construct("(b|a)(a|b)*c(aa|b)|bbbbbbbbbb");
+    ASSERT_TRUE(fa);
+    EXPECT_EQ(WordSampler(*fa).shortest_word(), "acb");
+
+    auto empty_word = FiniteAutomaton::construct("a*");
+    ASSERT_TRUE(empty_word);
+    EXPECT_EQ(WordSampler(*empty_word).shortest_word(), "");
+
+    auto empty = FiniteAutomaton::construct({'a'}, {0, 1}, {0}, {1}, {});
+    ASSERT_TRUE(empty);
+    EXPECT_FALSE(WordSampler(*empty).shortest_word());
+}
+
+TEST(WordSampler, RandomWord)
+{
+    auto fa = FiniteAutomaton::construct("(a|b)*a(a|b)");
+    ASSERT_TRUE(fa);
+    WordSampler sampler(*fa, 42);
+
+    std::map<std::string, unsigned> occurrences;
+    for (unsigned i = 0; i < 4000; ++i) {
+        auto word = sampler.random_word(3);
+        ASSERT_TRUE(word);
+        ASSERT_TRUE(fa->accepts(*word)) << *word;
+        ++occurrences[*word];
+    }
+
+    EXPECT_EQ(occurrences.size(), 4) << "Every accepted word of the length should be sampled";
+    for (const auto &[word, count] : occurrences)
+        EXPECT_NEAR(count, 1000, 150) << "The words should be sampled uniformly";
+
+    EXPECT_FALSE(sampler.random_word(1)) << "No accepted word is of length 1";
+    EXPECT_EQ(sampler.random_word(500)->size(), 500);
+}
+
+TEST(WordEnumerator, Shortlex)
+{
+    auto fa = FiniteAutomaton::construct("(a|b)*a");
+    ASSERT_TRUE(fa);
+
+    std::vector<std::string> words;
+    for (const auto &word : fa->enumerate_words(3))
+        words.emplace_back(word);
+    EXPECT_EQ(words, std::vector<std::string>({"a", "aa", "ba", "aaa", "aba", "baa", "bba"}));
+
+    auto even = FiniteAutomaton::construct("((a|b)(a|b))*|c");
+    ASSERT_TRUE(even);
+    words.clear();
+    for (const auto &word : even->enumerate_words(2))
+        words.emplace_back(word);
+    EXPECT_EQ(words, std::vector<std::string>({"", "c", "aa", "ab", "ba", "bb"}));
+
+    auto finite = FiniteAutomaton::construct("ab|c");
+    ASSERT_TRUE(finite);
+    auto finite_words = finite->enumerate_words(1000000);
+    EXPECT_EQ(std::ranges::distance(finite_words.begin(), finite_words.end()), 2)
+        << "Enumeration stops once no longer words exist";
+
+    auto empty = FiniteAutomaton::construct({'a'}, {0, 1}, {0}, {1}, {});
+    ASSERT_TRUE(empty);
+    auto no_words = empty->enumerate_words(10);
+    EXPECT_TRUE(no_words.begin() == no_words.end());
+}
+
+TEST(FiniteAutomatonCount, Finite)
+{
+    for (const auto &regex : {"a", "ab|c", "(a|b)(c|d)?e"})
+        EXPECT_TRUE(FiniteAutomaton::construct(regex)->is_finite()) << regex;
+
+    for (const auto &regex : {"a*", "ab+c", "(a|b)*aab"})
+        EXPECT_FALSE(FiniteAutomaton::construct(regex)->is_finite()) << regex;
+
+    auto dead_loop = FiniteAutomaton::construct(
+        {'a', 'b'}, {0, 1, 2}, {0}, {1}, {{{0, 'a'}, {1}}, {{0, 'b'}, {2}}, {{2, 'a'}, {2}}});
+    ASSERT_TRUE(dead_loop);
+    EXPECT_TRUE(dead_loop->is_finite()) << "Loops that can't lead to a final state don't make a language infinite";
+}
+
+TEST(FiniteAutomatonCount, Words)
+{
+    auto all = FiniteAutomaton::construct("(a|b)*");
+    ASSERT_TRUE(all);
+    EXPECT_EQ(all->count_words(0), 1);
+    EXPECT_EQ(all->count_words(3), 8);
+    EXPECT_EQ(all->count_words_up_to(3), 15);
+    EXPECT_EQ(all->count_words(64), std::numeric_limits<std::uint64_t>::max()) << "Counts saturate";
+    EXPECT_EQ(all->count_words_up_to(100), std::numeric_limits<std::uint64_t>::max());
+
+    auto second_to_last_a = FiniteAutomaton::construct("(a|b)*a(a|b)");
+    ASSERT_TRUE(second_to_last_a);
+    EXPECT_EQ(second_to_last_a->count_words(1), 0);
+    EXPECT_EQ(second_to_last_a->count_words(5), 16);
+
+    auto finite = FiniteAutomaton::construct("ab|c|de?");
+    ASSERT_TRUE(finite);
+    EXPECT_EQ(finite->count_words(1), 2);
+    EXPECT_EQ(finite->count_words(2), 2);
+    EXPECT_EQ(finite->count_words_up_to(1000000000), 4);
+
+    // Languages which grow slowly don't saturate, so the counts of long words are exact, on either side of the
+    // lengths past which the counts are no longer taken one length at a time.
+    auto a_then_b = FiniteAutomaton::construct("a*b*");
+    ASSERT_TRUE(a_then_b);
+    for (unsigned length = 0; length < 8; ++length) {
+        EXPECT_EQ(a_then_b->count_words(length), length + 1) << length;
+        EXPECT_EQ(a_then_b->count_words_up_to(length), (length + 1) * (length + 2) / 2) << length;
+    }
+    EXPECT_EQ(a_then_b->count_words(4000000000), 4000000001);
+    EXPECT_EQ(a_then_b->count_words_up_to(4000000000), 4000000001ull * 4000000002 / 2);
+    EXPECT_EQ(a_then_b->count_words_up_to(4294967295), (std::uint64_t(1) << 63) + (std::uint64_t(1) << 31));
+
+    auto odd_or_even = FiniteAutomaton::construct("(aa)*(b|cc)");
+    ASSERT_TRUE(odd_or_even);
+    for (unsigned length = 1; length < 8; ++length)
+        EXPECT_EQ(odd_or_even->count_words(3000000000 + length), 1) << length;
+    EXPECT_EQ(odd_or_even->count_words_up_to(3000000001), 3000000001);
+}
+
+TEST(StreamMatcher, Chunks)
+{
+    auto fa = FiniteAutomaton::construct("(ab)*c");
+    ASSERT_TRUE(fa);
+    StreamMatcher matcher(*fa);
+
+    EXPECT_FALSE(matcher.is_accepting());
+    for (const auto &chunk : {"a", "bab", "", "aba", "bc"}) {
+        matcher.feed(chunk);
+        EXPECT_FALSE(matcher.is_dead()) << "Every prefix fed so far can still be accepted";
+    }
+    EXPECT_TRUE(matcher.is_accepting());
+
+    matcher.feed("c");
+    EXPECT_FALSE(matcher.is_accepting());
+    EXPECT_TRUE(matcher.is_dead());
+    matcher.feed("abc");
+    EXPECT_TRUE(matcher.is_dead()) << "A dead matcher stays dead";
+
+    matcher.reset();
+    StreamMatcher shared(matcher.get_table());
+    matcher.feed("abc");
+    shared.feed("ab");
+    EXPECT_TRUE(matcher.is_accepting());
+    EXPECT_FALSE(shared.is_accepting()) << "Matchers sharing a table keep separate states";
+}
+
+TEST(MultiPatternMatcher, Match)
+{
+    const std::vector<std::string> patterns = {"a+b", "ab*", "(a|b)*b", "c"};
+    auto matcher = MultiPatternMatcher::construct(patterns);
+    ASSERT_TRUE(matcher);
+
+    EXPECT_EQ(matcher->match("ab"), std::vector<unsigned>({0, 1, 2}));
+    EXPECT_EQ(matcher->match("a"), std::vector<unsigned>({1}));
+    EXPECT_EQ(matcher->match("abb"), std::vector<unsigned>({1, 2}));
+    EXPECT_EQ(matcher->match("aab"), std::vector<unsigned>({0, 2}));
+    EXPECT_EQ(matcher->match("c"), std::vector<unsigned>({3}));
+    EXPECT_TRUE(matcher->match("").empty());
+    EXPECT_TRUE(matcher->match("ac").empty());
+    EXPECT_TRUE(matcher->match("x").empty());
+
+    for (const auto &word : {"ab", "ba", "aab", "c", "abbb"}) {
+        for (unsigned id = 0; id < patterns.size(); ++id) {
+            const auto &ids = matcher->match(word);
+            EXPECT_EQ(std::ranges::count(ids, id) == 1, FiniteAutomaton::construct(patterns[id])->accepts(word))
+                << word << " against " << patterns[id];
+        }
+    }
+
+    const std::vector<std::string> invalid = {"a", "(b"};
+    EXPECT_FALSE(MultiPatternMatcher::construct(invalid));
+}
+
+TEST(Searcher, Find)
+{
+    using match_t = Searcher::match_t;
+
+    auto fa = FiniteAutomaton::construct("ab+");
+    ASSERT_TRUE(fa);
+    Searcher searcher(*fa);
+
+    EXPECT_EQ(searcher.find_first("xxabbbyab"), match_t(2, 4)) << "The first match is reported as soon as it ends";
+    EXPECT_EQ(searcher.find_longest("xxabbbyab"), match_t(2, 6));
+    EXPECT_EQ(searcher.find_all("xxabbbyab"), std::vector<match_t>({{2, 4}, {7, 9}}));
+    EXPECT_FALSE(searcher.find_first("aaaa ba"));
+    EXPECT_FALSE(searcher.find_longest(""));
+
+    auto alternatives = FiniteAutomaton::construct("xabc|b");
+    ASSERT_TRUE(alternatives);
+    Searcher alternatives_searcher(*alternatives);
+    EXPECT_EQ(alternatives_searcher.find_first("xabc"), match_t(2, 3));
+    EXPECT_EQ(alternatives_searcher.find_longest("xabc"), match_t(0, 4)) << "The leftmost match wins";
+
+    auto repeated = FiniteAutomaton::construct("(ab)+");
+    ASSERT_TRUE(repeated);
+    Searcher repeated_searcher(*repeated);
+    EXPECT_EQ(repeated_searcher.find_first("aababab"), match_t(1, 3)) << "Starts never precede the search";
+    EXPECT_EQ(repeated_searcher.find_all("ab-abab"), std::vector<match_t>({{0, 2}, {3, 5}, {5, 7}}));
+
+    auto nullable = FiniteAutomaton::construct("a*");
+    ASSERT_TRUE(nullable);
+    Searcher nullable_searcher(*nullable);
+    EXPECT_EQ(nullable_searcher.find_first("baa"), match_t(0, 0));
+    EXPECT_EQ(nullable_searcher.find_longest("baa"), match_t(0, 0));
+    EXPECT_EQ(nullable_searcher.find_all("ab"), std::vector<match_t>({{0, 0}, {0, 1}, {2, 2}}))
+        << "Empty matches must not repeat at the same position";
+}
+
+TEST(LineScanner, Scan)
+{
+    using line_t = LineScanner::line_t;
+
+    auto fa = FiniteAutomaton::construct("ab+");
+    ASSERT_TRUE(fa);
+    LineScanner whole_lines(*fa, LineScanner::Mode::WholeLine);
+    LineScanner substrings(*fa, LineScanner::Mode::Substring);
+
+    const std::string_view text = "ab\nxabbb\n\nabbb\nb";
+    EXPECT_EQ(whole_lines.scan(text), std::vector<line_t>({{1, "ab"}, {4, "abbb"}}));
+    EXPECT_EQ(substrings.scan(text), std::vector<line_t>({{1, "ab"}, {2, "xabbb"}, {4, "abbb"}}));
+    EXPECT_EQ(substrings.count(text), 3);
+    EXPECT_TRUE(whole_lines.scan("").empty());
+
+    // The carriage returns of CRLF line breaks are no part of the lines.
+    EXPECT_EQ(whole_lines.scan("ab\r\nx\r\nabb"), std::vector<line_t>({{1, "ab"}, {3, "abb"}}));
+    EXPECT_EQ(whole_lines.count("abb\r\n\r\nab\r\n"), 2);
+
+    // Enough lines to be split into chunks for separate threads.
+    std::string long_text;
+    for (unsigned i = 0; i < 100000; ++i)
+        long_text += i % 3 == 0 ? "abb\n" : "ba\n";
+    const auto lines = whole_lines.scan(long_text, 4);
+    ASSERT_EQ(lines.size(), 33334);
+    EXPECT_EQ(lines.back(), line_t(100000, "abb")) << "Line numbers must carry over between chunks";
+    EXPECT_EQ(whole_lines.count(long_text, 4), 33334);
+}
+
+TEST(SceneFile, ReadWrite)
+{
+    auto fa = FiniteAutomaton::construct({'a'}, {0, 1}, {0}, {1}, {{{0, 'a'}, {1}}});
+    ASSERT_TRUE(fa);
+
+    // The layout QDataStream gave a scene with this automaton centered at (1, -2), before versioning.
+    const std::string legacy = std::string("\0\0\0\0\0\0\0\1", 8) + std::string("\0\0\0\1a", 5)
+                               + std::string("\0\0\0\2\0\0\0\0\0\0\0\1", 12)
+                               + std::string("\0\0\0\1\0\0\0\0", 8) + std::string("\0\0\0\1\0\0\0\1", 8)
+                               + std::string("\0\0\0\1\0\0\0\0a\0\0\0\1\0\0\0\1", 17)
+                               + std::string("\x3f\xf0\0\0\0\0\0\0\xc0\0\0\0\0\0\0\0", 16);
+    const std::vector<SceneFile::Item> items = {{*fa, 1, -2}};
+
+    for (const auto &contents : {legacy, SceneFile::write(items)}) {
+        auto read_items = SceneFile::read(contents);
+        ASSERT_TRUE(read_items);
+        ASSERT_EQ(read_items->size(), 1);
+        EXPECT_EQ((*read_items)[0].automaton.get_transition_function(), fa->get_transition_function());
+        EXPECT_EQ((*read_items)[0].x, 1);
+        EXPECT_EQ((*read_items)[0].y, -2);
+
+        EXPECT_FALSE(SceneFile::read(contents.substr(0, contents.size() - 1))) << "Truncated files are invalid";
+    }
+    EXPECT_FALSE(SceneFile::read(std::string("\0\0\0\0\0\0\0\1\xff\xff\xff\xfe", 12)));
+    EXPECT_FALSE(SceneFile::read(std::string("FATS\x01\0\0\0\0\0\0\0\0", 13))) << "Only version 2 is supported";
+
+    // Identical automata share their data, while ones which only accept the same words don't.
+    const auto a_r = FiniteAutomaton::construct("a");
+    ASSERT_TRUE(a_r);
+    const std::vector<SceneFile::Item> repeated = {{*fa, 0, 0}, {*fa, 1, 1}, {*a_r, 2, 2}};
+    const auto repeated_contents = SceneFile::write(repeated);
+    // The repeated automaton only adds an entry of 32 bytes to the table of contents.
+    const std::vector<SceneFile::Item> distinct(repeated.begin() + 1, repeated.end());
+    EXPECT_EQ(repeated_contents.size(), SceneFile::write(distinct).size() + 32);
+    auto read_repeated = SceneFile::read(repeated_contents);
+    ASSERT_TRUE(read_repeated);
+    ASSERT_EQ(read_repeated->size(), 3);
+    EXPECT_EQ((*read_repeated)[1].automaton.get_states(), fa->get_states());
+    EXPECT_EQ((*read_repeated)[2].automaton.get_states(), a_r->get_states());
+
+    auto regexes = SceneFile::read_regexes("ab*\n\n(a|b)*c\r\n");
+    ASSERT_TRUE(regexes);
+    ASSERT_EQ(regexes->size(), 2);
+    EXPECT_TRUE((*regexes)[1].accepts("abc"));
+    EXPECT_FALSE(SceneFile::read_regexes("a\n(b"));
+}
+
+TEST(SceneFile, Index)
+{
+    std::vector<SceneFile::Item> items;
+    for (const auto &regex : {"a*", "(a|b)c", "abc+"})
+        items.push_back({*FiniteAutomaton::construct(regex), 100.0 * items.size(), 1});
+    auto contents = SceneFile::write(items);
+
+    // Corrupting the last automaton only fails its own loading, as nothing is decoded until needed.
+    contents.back() ^= 1;
+    auto index = SceneFile::Index::read(contents);
+    ASSERT_TRUE(index);
+    ASSERT_EQ(index->size(), 3);
+    EXPECT_EQ(index->get_center(2), std::make_pair(200.0, 1.0));
+    auto automaton = index->load(1);
+    ASSERT_TRUE(automaton);
+    EXPECT_TRUE(automaton->accepts("bc"));
+    EXPECT_FALSE(index->load(2));
+    EXPECT_FALSE(SceneFile::read(contents));
+
+    EXPECT_FALSE(SceneFile::Index::read(contents.substr(0, 40))) << "The table of contents must be complete";
+
+    // The automaton which failed to load is written back unchanged.
+    const std::vector<SceneFile::RawItem> raw_items = {{std::string(index->get_data(2)), 5, 6}};
+    const auto rewritten = SceneFile::write(std::span(items).first(2), raw_items);
+    auto rewritten_index = SceneFile::Index::read(rewritten);
+    ASSERT_TRUE(rewritten_index);
+    ASSERT_EQ(rewritten_index->size(), 3);
+    EXPECT_EQ(rewritten_index->get_data(2), index->get_data(2));
+    EXPECT_EQ(rewritten_index->get_center(2), std::make_pair(5.0, 6.0));
+    EXPECT_TRUE(rewritten_index->load(1));
+    EXPECT_FALSE(rewritten_index->load(2));
+}
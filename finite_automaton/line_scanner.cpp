@@ -0,0 +1,116 @@
+#include "line_scanner.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+// Calls the visitor with each line of a chunk, which ends right after a line break (or at the end of the text).
+// The carriage return of a CRLF line break is no part of the line either.
+void for_each_line(std::string_view chunk, const auto &visitor)
+{
+    while (!chunk.empty()) {
+        const auto line_end = std::min(chunk.find('\n'), chunk.size());
+        auto line = chunk.substr(0, line_end);
+        if (line.ends_with('\r'))
+            line.remove_suffix(1);
+        visitor(line);
+        chunk.remove_prefix(std::min(line_end + 1, chunk.size()));
+    }
+}
+} // namespace
+
+LineScanner::LineScanner(const FiniteAutomaton &automaton, Mode mode) : m_mode(mode)
+{
+    if (m_mode == Mode::WholeLine)
+        m_table.emplace(automaton.minimize());
+    else
+        m_searcher.emplace(automaton);
+}
+
+std::vector<LineScanner::line_t> LineScanner::scan(std::string_view text, unsigned num_of_threads) const
+{
+    const auto chunks = split_into_chunks(text, num_of_threads);
+
+    // Line numbers within each chunk are only made global once the lines of the preceding chunks are counted.
+    // The threads collect into locals and store them once they are done, as the neighbouring elements of the
+    // shared vectors would otherwise bounce the same cache lines between the threads on every line.
+    std::vector<std::vector<line_t>> chunk_lines(chunks.size());
+    std::vector<size_t> chunk_line_counts(chunks.size(), 0);
+    {
+        std::vector<std::jthread> threads;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            threads.emplace_back([&, i]() {
+                std::vector<line_t> selected;
+                size_t line_count = 0;
+                for_each_line(chunks[i], [&](std::string_view line) {
+                    if (is_selected(line))
+                        selected.emplace_back(line_count + 1, line);
+                    ++line_count;
+                });
+                chunk_lines[i] = std::move(selected);
+                chunk_line_counts[i] = line_count;
+            });
+        }
+    }
+
+    std::vector<line_t> lines;
+    size_t preceding_lines = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        for (const auto &[number, line] : chunk_lines[i])
+            lines.emplace_back(preceding_lines + number, line);
+        preceding_lines += chunk_line_counts[i];
+    }
+
+    return lines;
+}
+
+size_t LineScanner::count(std::string_view text, unsigned num_of_threads) const
+{
+    const auto chunks = split_into_chunks(text, num_of_threads);
+
+    // As in scan, each thread counts into a local and stores it once.
+    std::vector<size_t> chunk_counts(chunks.size(), 0);
+    {
+        std::vector<std::jthread> threads;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            threads.emplace_back([&, i]() {
+                size_t chunk_count = 0;
+                for_each_line(chunks[i], [&](std::string_view line) { chunk_count += is_selected(line); });
+                chunk_counts[i] = chunk_count;
+            });
+        }
+    }
+
+    size_t count = 0;
+    for (const auto &chunk_count : chunk_counts)
+        count += chunk_count;
+    return count;
+}
+
+bool LineScanner::is_selected(std::string_view line) const
+{
+    return m_mode == Mode::WholeLine ? m_table->accepts(line) : m_searcher->find_first(line).has_value();
+}
+
+std::vector<std::string_view> LineScanner::split_into_chunks(std::string_view text, unsigned num_of_threads) const
+{
+    // Below this many bytes per chunk, starting a thread costs more than it saves.
+    constexpr size_t min_chunk_size = 1 << 16;
+
+    if (num_of_threads == 0)
+        num_of_threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t num_of_chunks = std::clamp<size_t>(text.size() / min_chunk_size, 1, num_of_threads);
+    const size_t chunk_size = text.size() / num_of_chunks;
+
+    // Each chunk is extended up to the end of the line it would otherwise split.
+    std::vector<std::string_view> chunks;
+    while (!text.empty()) {
+        const bool last_chunk = chunks.size() + 1 == num_of_chunks;
+        const auto line_break = last_chunk ? std::string_view::npos : text.find('\n', chunk_size);
+        const auto chunk_end = line_break == std::string_view::npos ? text.size() : line_break + 1;
+        chunks.push_back(text.substr(0, chunk_end));
+        text.remove_prefix(chunk_end);
+    }
+
+    return chunks;
+}
@@ -0,0 +1,45 @@
+#ifndef LINE_SCANNER_HPP
+#define LINE_SCANNER_HPP
+
+#include "dfa_table.hpp"
+#include "finite_automaton.hpp"
+#include "searcher.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Selects the lines of a text (e.g. of a MappedFile) which an automaton accepts, or in which it finds
+// a match. The text is split into chunks of whole lines, which are scanned by separate threads, and
+// the lines are only ever referred to by views into the text, never copied.
+class LineScanner
+{
+  public:
+    enum class Mode
+    {
+        WholeLine,
+        Substring
+    };
+
+    // Number of the line (starting from 1) and its contents, without the line break.
+    using line_t = std::pair<size_t, std::string_view>;
+
+    LineScanner(const FiniteAutomaton &automaton, Mode mode);
+
+    // A number of threads of 0 stands for the number of hardware threads.
+    std::vector<line_t> scan(std::string_view text, unsigned num_of_threads = 0) const;
+    size_t count(std::string_view text, unsigned num_of_threads = 0) const;
+
+  private:
+    bool is_selected(std::string_view line) const;
+    std::vector<std::string_view> split_into_chunks(std::string_view text, unsigned num_of_threads) const;
+
+    Mode m_mode;
+    // Only the one the mode needs is built.
+    std::optional<DfaTable> m_table;
+    std::optional<Searcher> m_searcher;
+};
+
+#endif // LINE_SCANNER_HPP
@@ -0,0 +1,86 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+#include <fstream>
+#include <sstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+std::expected<MappedFile, std::string> MappedFile::open(const std::string &path)
+{
+    MappedFile file;
+
+#ifdef _WIN32
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream)
+        return std::unexpected("Cannot open file: " + path);
+    std::ostringstream contents;
+    contents << stream.rdbuf();
+    file.m_buffer = std::move(contents).str();
+    file.m_data = file.m_buffer.data();
+    file.m_size = file.m_buffer.size();
+#else
+    const int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor == -1)
+        return std::unexpected("Cannot open file: " + path);
+
+    struct stat status;
+    if (fstat(descriptor, &status) == -1) {
+        close(descriptor);
+        return std::unexpected("Cannot read file: " + path);
+    }
+
+    // Empty files can't be mapped, but there is nothing to map anyway.
+    if (status.st_size > 0) {
+        void *data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (data == MAP_FAILED) {
+            close(descriptor);
+            return std::unexpected("Cannot map file: " + path);
+        }
+        madvise(data, status.st_size, MADV_SEQUENTIAL);
+        file.m_data = static_cast<const char *>(data);
+        file.m_size = status.st_size;
+    }
+    close(descriptor);
+#endif
+
+    return file;
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+#ifdef _WIN32
+    // Moving a short string moves its characters, so the view is taken anew.
+    m_buffer = std::move(other.m_buffer);
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#else
+    if (m_data)
+        munmap(const_cast<char *>(m_data), m_size);
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+#endif
+
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+    if (m_data)
+        munmap(const_cast<char *>(m_data), m_size);
+#endif
+}
+
+std::string_view MappedFile::get_contents() const { return {m_data, m_size}; }
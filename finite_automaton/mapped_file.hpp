@@ -0,0 +1,32 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <expected>
+#include <string>
+#include <string_view>
+
+// Read-only view of the contents of a whole file, which is memory-mapped where supported (and read
+// into memory elsewhere), so that even files larger than the memory can be scanned without copying.
+class MappedFile
+{
+  public:
+    static std::expected<MappedFile, std::string> open(const std::string &path);
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    ~MappedFile();
+
+    std::string_view get_contents() const;
+
+  private:
+    MappedFile() = default;
+
+    const char *m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    std::string m_buffer;
+#endif
+};
+
+#endif // MAPPED_FILE_HPP
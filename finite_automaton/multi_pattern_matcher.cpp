@@ -0,0 +1,58 @@
+#include "multi_pattern_matcher.hpp"
+
+#include <ranges>
+
+std::expected<MultiPatternMatcher, std::string> MultiPatternMatcher::construct(std::span<const std::string> regexes)
+{
+    auto pattern_union = FiniteAutomaton::construct(regexes);
+    if (!pattern_union)
+        return std::unexpected(pattern_union.error());
+
+    // The final states of the union follow the order of the patterns.
+    const std::vector<unsigned> pattern_final_states(
+        pattern_union->m_final_states.begin(), pattern_union->m_final_states.end());
+
+    auto [automaton, subsets] = pattern_union->determinize_with_subsets();
+
+    std::vector<std::vector<unsigned>> pattern_ids(subsets.size());
+    for (unsigned state = 0; state < subsets.size(); ++state) {
+        for (unsigned id = 0; id < pattern_final_states.size(); ++id) {
+            if (subsets[state].contains(pattern_final_states[id]))
+                pattern_ids[state].push_back(id);
+        }
+    }
+
+    return MultiPatternMatcher(std::move(automaton), pattern_ids);
+}
+
+const std::vector<unsigned> &MultiPatternMatcher::match(std::string_view word) const
+{
+    const auto dead_state = m_table.get_dead_state();
+
+    auto state = m_table.get_initial_state();
+    for (const auto &symbol : word) {
+        state = m_table.next(state, symbol);
+        if (state == dead_state)
+            break;
+    }
+
+    return m_table_pattern_ids[state];
+}
+
+const FiniteAutomaton &MultiPatternMatcher::get_automaton() const { return m_automaton; }
+
+const std::vector<unsigned> &MultiPatternMatcher::get_pattern_ids(unsigned automaton_state) const
+{
+    return m_automaton_pattern_ids.at(automaton_state);
+}
+
+MultiPatternMatcher::MultiPatternMatcher(
+    FiniteAutomaton automaton, const std::vector<std::vector<unsigned>> &pattern_ids)
+    : m_automaton(std::move(automaton)), m_automaton_pattern_ids(pattern_ids), m_table(m_automaton),
+      m_table_pattern_ids(m_table.get_num_of_states())
+{
+    // The table isn't minimized, since that could merge states accepting different patterns. Only
+    // states that can't lead to a final state are merged into the dead one, none of which is tagged.
+    for (unsigned state = 0; state < pattern_ids.size(); ++state)
+        m_table_pattern_ids[*m_table.get_state(state)] = pattern_ids[state];
+}
@@ -0,0 +1,36 @@
+#ifndef MULTI_PATTERN_MATCHER_HPP
+#define MULTI_PATTERN_MATCHER_HPP
+
+#include "dfa_table.hpp"
+#include "finite_automaton.hpp"
+
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Matches a word against a whole set of regexes in a single pass. The regexes are compiled into one
+// deterministic automaton, whose states are tagged with the ids (indices) of the patterns they accept.
+class MultiPatternMatcher
+{
+  public:
+    static std::expected<MultiPatternMatcher, std::string> construct(std::span<const std::string> regexes);
+
+    // The ids of all of the patterns matching the word, in increasing order.
+    const std::vector<unsigned> &match(std::string_view word) const;
+
+    // The deterministic automaton of all of the patterns, whose final states are tagged.
+    const FiniteAutomaton &get_automaton() const;
+    const std::vector<unsigned> &get_pattern_ids(unsigned automaton_state) const;
+
+  private:
+    MultiPatternMatcher(FiniteAutomaton automaton, const std::vector<std::vector<unsigned>> &pattern_ids);
+
+    FiniteAutomaton m_automaton;
+    std::vector<std::vector<unsigned>> m_automaton_pattern_ids;
+    DfaTable m_table;
+    std::vector<std::vector<unsigned>> m_table_pattern_ids;
+};
+
+#endif // MULTI_PATTERN_MATCHER_HPP
@@ -0,0 +1,263 @@
+#include "regex_dag.hpp"
+#include "finite_automaton.hpp"
+
+#include <map>
+
+unsigned RegexDag::epsilon() { return intern({Kind::Epsilon}); }
+
+unsigned RegexDag::symbol(char symbol) { return intern({Kind::Symbol, symbol}); }
+
+unsigned RegexDag::concatenation(unsigned left, unsigned right)
+{
+    if (m_nodes[left].kind == Kind::Epsilon)
+        return right;
+    if (m_nodes[right].kind == Kind::Epsilon)
+        return left;
+    return intern({Kind::Concatenation, 0, left, right});
+}
+
+unsigned RegexDag::alternation(unsigned left, unsigned right)
+{
+    if (left == right)
+        return left;
+
+    // An alternation with the empty word is an optional operand.
+    if (m_nodes[left].kind == Kind::Epsilon)
+        std::swap(left, right);
+    if (m_nodes[right].kind == Kind::Epsilon) {
+        const auto kind = m_nodes[left].kind;
+        if (kind == Kind::ZeroOrOne || kind == Kind::ZeroOrMore)
+            return left;
+        return intern({Kind::ZeroOrOne, 0, left});
+    }
+
+    return intern({Kind::Alternation, 0, left, right});
+}
+
+unsigned RegexDag::zero_or_more(unsigned operand)
+{
+    switch (m_nodes[operand].kind) {
+    case Kind::Epsilon:
+    case Kind::ZeroOrMore:
+        return operand;
+    case Kind::ZeroOrOne:
+        return zero_or_more(m_nodes[operand].left);
+    default:
+        return intern({Kind::ZeroOrMore, 0, operand});
+    }
+}
+
+unsigned RegexDag::import(const RegexDag &other, unsigned node)
+{
+    // Done with an explicit stack, since chains of concatenations are as deep as they are long. A node stays
+    // on the stack until its operands are imported, the left one first.
+    std::unordered_map<unsigned, unsigned> imported;
+    std::vector<unsigned> node_stack = {node};
+    while (!node_stack.empty()) {
+        const auto current = node_stack.back();
+        if (imported.contains(current)) {
+            node_stack.pop_back();
+            continue;
+        }
+
+        auto copy = other.m_nodes[current];
+        const bool has_left = copy.kind != Kind::Epsilon && copy.kind != Kind::Symbol;
+        const bool has_right = copy.kind == Kind::Concatenation || copy.kind == Kind::Alternation;
+        const bool right_missing = has_right && !imported.contains(copy.right);
+        const bool left_missing = has_left && !imported.contains(copy.left);
+        if (right_missing)
+            node_stack.push_back(copy.right);
+        if (left_missing)
+            node_stack.push_back(copy.left);
+        if (left_missing || right_missing)
+            continue;
+
+        if (has_left)
+            copy.left = imported[copy.left];
+        if (has_right)
+            copy.right = imported[copy.right];
+        imported[current] = intern(copy);
+        node_stack.pop_back();
+    }
+
+    return imported[node];
+}
+
+void RegexDag::set_root(unsigned node) { m_root = node; }
+
+unsigned RegexDag::get_root() const { return m_root; }
+
+const RegexDag::Node &RegexDag::get_node(unsigned node) const { return m_nodes[node]; }
+
+size_t RegexDag::size() const { return m_nodes.size(); }
+
+namespace {
+unsigned precedence(RegexDag::Kind kind)
+{
+    switch (kind) {
+    case RegexDag::Kind::Alternation:
+        return 0;
+    case RegexDag::Kind::Concatenation:
+        return 1;
+    case RegexDag::Kind::ZeroOrOne:
+    case RegexDag::Kind::ZeroOrMore:
+        return 2;
+    default:
+        return 3;
+    }
+}
+
+// Writes out a node, replacing the named subexpressions (other than the node itself) with references. The
+// pieces of output still to be written are kept on an explicit stack, since chains of concatenations are as
+// deep as they are long.
+void write_node(
+    const RegexDag &dag, unsigned node, const std::map<unsigned, unsigned> &names, bool escape, std::string &out)
+{
+    struct Task
+    {
+        enum class Type
+        {
+            // A node written out as it is.
+            Node,
+            // An operand, which may be a reference or need parentheses.
+            Operand,
+            Text
+        } type;
+        unsigned node = 0;
+        unsigned min_precedence = 0;
+        char text = 0;
+    };
+    std::vector<Task> tasks = {{Task::Type::Node, node}};
+    const auto push_operand = [&](unsigned operand, unsigned min_precedence) {
+        tasks.push_back({Task::Type::Operand, operand, min_precedence});
+    };
+    const auto push_text = [&](char text) { tasks.push_back({Task::Type::Text, 0, 0, text}); };
+
+    while (!tasks.empty()) {
+        const auto task = tasks.back();
+        tasks.pop_back();
+
+        if (task.type == Task::Type::Text) {
+            out += task.text;
+            continue;
+        }
+        if (task.type == Task::Type::Operand) {
+            auto it = names.find(task.node);
+            if (it != names.end()) {
+                out += "{r" + std::to_string(it->second) + "}";
+            } else if (precedence(dag.get_node(task.node).kind) < task.min_precedence) {
+                push_text(')');
+                tasks.push_back({Task::Type::Node, task.node});
+                push_text('(');
+            } else
+                tasks.push_back({Task::Type::Node, task.node});
+            continue;
+        }
+
+        // The pieces are pushed in reverse, so that they are written in order.
+        const auto &current = dag.get_node(task.node);
+        switch (current.kind) {
+        case RegexDag::Kind::Epsilon:
+            out += FiniteAutomaton::epsilon_transition_value;
+            break;
+        case RegexDag::Kind::Symbol:
+            if (escape && (current.symbol == '{' || current.symbol == '}' || current.symbol == '\\'))
+                out += '\\';
+            out += current.symbol;
+            break;
+        case RegexDag::Kind::Concatenation:
+            push_operand(current.right, 1);
+            push_operand(current.left, 1);
+            break;
+        case RegexDag::Kind::Alternation:
+            push_operand(current.right, 0);
+            push_text('|');
+            push_operand(current.left, 0);
+            break;
+        case RegexDag::Kind::ZeroOrOne:
+            // Chained unary operators are not valid without parentheses.
+            push_text('?');
+            push_operand(current.left, 3);
+            break;
+        case RegexDag::Kind::ZeroOrMore:
+            push_text('*');
+            push_operand(current.left, 3);
+            break;
+        }
+    }
+}
+} // namespace
+
+std::string RegexDag::expand() const { return expand(m_root); }
+
+std::string RegexDag::expand(unsigned node) const
+{
+    std::string out;
+    write_node(*this, node, {}, false, out);
+    return out;
+}
+
+std::string RegexDag::to_definitions() const
+{
+    const auto is_compound = [this](unsigned node) {
+        return m_nodes[node].kind != Kind::Epsilon && m_nodes[node].kind != Kind::Symbol;
+    };
+
+    // Count the uses of each subexpression reachable from the root, then
+    // name the shared ones in post-order, so that definitions only ever
+    // refer to the ones preceding them. The stack holds the nodes along with
+    // whether their operands have been pushed already.
+    std::vector<unsigned> uses(m_nodes.size(), 0);
+    std::vector<unsigned> post_order;
+    std::vector<std::pair<unsigned, bool>> node_stack = {{m_root, false}};
+    while (!node_stack.empty()) {
+        const auto [node, expanded] = node_stack.back();
+        node_stack.pop_back();
+        if (expanded) {
+            post_order.push_back(node);
+            continue;
+        }
+        if (uses[node]++ > 0 || !is_compound(node))
+            continue;
+        node_stack.push_back({node, true});
+        if (m_nodes[node].kind == Kind::Concatenation || m_nodes[node].kind == Kind::Alternation)
+            node_stack.push_back({m_nodes[node].right, false});
+        node_stack.push_back({m_nodes[node].left, false});
+    }
+
+    std::map<unsigned, unsigned> names;
+    std::string out;
+    for (const auto &node : post_order) {
+        if (uses[node] < 2 || node == m_root)
+            continue;
+        const auto name = names.size();
+        out += "r" + std::to_string(name) + " = ";
+        write_node(*this, node, names, true, out);
+        out += '\n';
+        names[node] = name;
+    }
+
+    write_node(*this, m_root, names, true, out);
+    return out;
+}
+
+size_t RegexDag::NodeHash::operator()(const Node &node) const
+{
+    size_t hash = static_cast<size_t>(node.kind);
+    const auto symbol = static_cast<size_t>(static_cast<unsigned char>(node.symbol));
+    for (size_t value : {symbol, size_t{node.left}, size_t{node.right}})
+        hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+unsigned RegexDag::intern(const Node &node)
+{
+    auto it = m_node_ids.find(node);
+    if (it != m_node_ids.end())
+        return it->second;
+
+    const unsigned id = m_nodes.size();
+    m_nodes.push_back(node);
+    m_node_ids.insert({node, id});
+    return id;
+}
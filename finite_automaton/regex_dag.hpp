@@ -0,0 +1,71 @@
+#ifndef REGEX_DAG_HPP
+#define REGEX_DAG_HPP
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Hash-consed regular expression, in which every distinct subexpression is stored exactly once
+// and referred to by its node index. Building the same expression twice yields the same node,
+// so repeated subexpressions don't multiply the size of the expression.
+class RegexDag
+{
+  public:
+    enum class Kind
+    {
+        Epsilon,
+        Symbol,
+        Concatenation,
+        Alternation,
+        ZeroOrOne,
+        ZeroOrMore
+    };
+
+    struct Node
+    {
+        Kind kind;
+        char symbol = 0;
+        unsigned left = 0, right = 0;
+
+        bool operator==(const Node &other) const = default;
+    };
+
+    // The node builders apply some trivial simplifications (e.g. the epsilon
+    // being neutral for concatenation) before looking up the node.
+    unsigned epsilon();
+    unsigned symbol(char symbol);
+    unsigned concatenation(unsigned left, unsigned right);
+    unsigned alternation(unsigned left, unsigned right);
+    unsigned zero_or_more(unsigned operand);
+
+    // Copies a subexpression of another DAG into this one, returning its node index here.
+    unsigned import(const RegexDag &other, unsigned node);
+
+    void set_root(unsigned node);
+    unsigned get_root() const;
+    const Node &get_node(unsigned node) const;
+    size_t size() const;
+
+    // Flat form of the expression, in which shared subexpressions are written out at every use.
+    std::string expand() const;
+    std::string expand(unsigned node) const;
+
+    // Form of the expression in which every non-trivial subexpression used more than once is written
+    // exactly once, as a definition "rN = ..." on its own line, and referred to as {rN} afterwards.
+    // The last line is the expression itself. Braces and backslashes of the alphabet are escaped.
+    std::string to_definitions() const;
+
+  private:
+    struct NodeHash
+    {
+        size_t operator()(const Node &node) const;
+    };
+
+    unsigned intern(const Node &node);
+
+    std::vector<Node> m_nodes;
+    std::unordered_map<Node, unsigned, NodeHash> m_node_ids;
+    unsigned m_root = 0;
+};
+
+#endif // REGEX_DAG_HPP
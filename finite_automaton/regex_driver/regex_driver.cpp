@@ -3,7 +3,7 @@
 std::unique_ptr<RegexAST> RegexDriver::parse(const std::string &regex)
 {
     string_scan_init(regex);
-    yy::parser parser(*this);
+    yy::parser parser(*this, m_scanner);
     int res = parser();
     string_scan_deinit();
 
@@ -21,11 +21,14 @@ class RegexDriver
     void string_scan_deinit();
 
     std::unique_ptr<RegexAST> m_ast;
+    // The scanner is reentrant, so that regexes can be parsed from several threads at once,
+    // each with a driver of its own.
+    yyscan_t m_scanner = nullptr;
 };
 
-// By default, yylex's signature is int yylex(void),
+// By default, yylex's signature is int yylex(yyscan_t yyscanner),
 // so we have to redefine it.
-#define YY_DECL yy::parser::symbol_type yylex(RegexDriver &driver)
+#define YY_DECL yy::parser::symbol_type yylex(RegexDriver &driver, yyscan_t yyscanner)
 // Declare yylex for use in the parser.
 YY_DECL;
 
@@ -0,0 +1,286 @@
+#include "scene_file.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+
+namespace {
+constexpr std::string_view scene_magic = "FATS";
+// The table of contents gives the offset from the start of the file, the size and the center of each automaton.
+constexpr std::uint8_t scene_version = 2;
+constexpr size_t toc_entry_size = 2 * sizeof(std::uint64_t) + 2 * sizeof(double);
+
+// Marks a size too large for 32 bits, which is followed by the actual 64-bit size (since Qt 6.7).
+constexpr std::uint32_t extended_size = 0xfffffffe;
+
+// Converts between the native and the given byte order, which is the same conversion both ways.
+template <std::endian byte_order, typename T> T convert_byte_order(T value)
+{
+    if constexpr (std::endian::native != byte_order && sizeof(T) > 1) {
+        using uint_t = std::conditional_t<sizeof(T) == 8, std::uint64_t, std::uint32_t>;
+        return std::bit_cast<T>(std::byteswap(std::bit_cast<uint_t>(value)));
+    }
+    return value;
+}
+
+template <std::endian byte_order> class Reader
+{
+  public:
+    explicit Reader(std::string_view contents) : m_contents(contents) {}
+
+    template <typename T> std::optional<T> read()
+    {
+        if (m_contents.size() < sizeof(T))
+            return std::nullopt;
+
+        T value;
+        std::memcpy(&value, m_contents.data(), sizeof(T));
+        m_contents.remove_prefix(sizeof(T));
+        return convert_byte_order<byte_order>(value);
+    }
+
+    // Sizes of QDataStream containers, checked against what is left to read so that corrupt files can't
+    // cause huge allocations.
+    std::optional<std::uint64_t> read_size(size_t min_element_size)
+    {
+        std::optional<std::uint64_t> size = read<std::uint32_t>();
+        if (size == extended_size)
+            size = read<std::int64_t>();
+        if (!size || *size > m_contents.size() / min_element_size)
+            return std::nullopt;
+        return size;
+    }
+
+    std::optional<std::set<unsigned>> read_states()
+    {
+        auto size = read_size(sizeof(std::uint32_t));
+        if (!size)
+            return std::nullopt;
+
+        std::set<unsigned> states;
+        for (std::uint64_t i = 0; i < *size; ++i)
+            states.insert(*read<std::uint32_t>());
+        return states;
+    }
+
+    bool at_end() const { return m_contents.empty(); }
+
+  private:
+    std::string_view m_contents;
+};
+
+template <typename T> void append_little_endian(std::string &contents, T value)
+{
+    value = convert_byte_order<std::endian::little>(value);
+    contents.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+// The format of the scenes saved before versioning, which is that of QDataStream.
+std::expected<FiniteAutomaton, std::string> read_legacy_automaton(Reader<std::endian::big> &in)
+{
+    const auto format_error = std::unexpected("File format error");
+
+    auto alphabet_size = in.read_size(sizeof(char));
+    if (!alphabet_size)
+        return format_error;
+    std::set<char> alphabet;
+    for (std::uint64_t i = 0; i < *alphabet_size; ++i)
+        alphabet.insert(*in.read<char>());
+
+    auto states = in.read_states();
+    auto initial_states = in.read_states();
+    auto final_states = in.read_states();
+    if (!states || !initial_states || !final_states)
+        return format_error;
+
+    // Each transition takes at least its key and the size of its target states.
+    auto num_of_transitions = in.read_size(2 * sizeof(std::uint32_t) + sizeof(char));
+    if (!num_of_transitions)
+        return format_error;
+    std::map<std::pair<unsigned, char>, std::set<unsigned>> transition_function;
+    for (std::uint64_t i = 0; i < *num_of_transitions; ++i) {
+        auto from_state = in.read<std::uint32_t>();
+        auto symbol = in.read<char>();
+        auto to_states = from_state && symbol ? in.read_states() : std::nullopt;
+        if (!to_states)
+            return format_error;
+        transition_function[{*from_state, *symbol}] = std::move(*to_states);
+    }
+
+    return FiniteAutomaton::construct(
+        std::move(alphabet), std::move(*states), std::move(*initial_states), std::move(*final_states),
+        std::move(transition_function));
+}
+
+std::expected<std::vector<SceneFile::Item>, std::string> read_legacy(std::string_view contents)
+{
+    Reader<std::endian::big> in(contents);
+
+    auto num_of_automata = in.read<std::int64_t>();
+    if (!num_of_automata || *num_of_automata < 0)
+        return std::unexpected("File format error");
+
+    std::vector<SceneFile::Item> items;
+    for (std::int64_t i = 0; i < *num_of_automata; ++i) {
+        auto automaton = read_legacy_automaton(in);
+        if (!automaton)
+            return std::unexpected(automaton.error());
+        auto x = in.read<double>();
+        auto y = in.read<double>();
+        if (!x || !y)
+            return std::unexpected("File format error");
+        items.push_back({std::move(*automaton), *x, *y});
+    }
+
+    if (!in.at_end())
+        return std::unexpected("File format error");
+
+    return items;
+}
+} // namespace
+
+std::expected<SceneFile::Index, std::string> SceneFile::Index::read(std::string_view contents)
+{
+    const auto format_error = std::unexpected("File format error");
+    Index index;
+
+    if (!contents.starts_with(scene_magic)) {
+        auto items = read_legacy(contents);
+        if (!items)
+            return std::unexpected(items.error());
+        index.m_legacy_items = std::move(*items);
+        return index;
+    }
+
+    Reader<std::endian::little> in(contents.substr(scene_magic.size()));
+    const auto version = in.read<std::uint8_t>();
+    if (version != scene_version)
+        return std::unexpected("Unsupported file format version");
+
+    auto num_of_automata = in.read<std::uint64_t>();
+    if (!num_of_automata || *num_of_automata > contents.size() / toc_entry_size)
+        return format_error;
+    for (std::uint64_t i = 0; i < *num_of_automata; ++i) {
+        auto offset = in.read<std::uint64_t>();
+        auto size = in.read<std::uint64_t>();
+        auto x = in.read<double>();
+        auto y = in.read<double>();
+        if (!offset || !size || !x || !y || *offset > contents.size() || *size > contents.size() - *offset)
+            return format_error;
+        index.m_entries.push_back({contents.substr(*offset, *size), *x, *y});
+    }
+
+    return index;
+}
+
+size_t SceneFile::Index::size() const { return m_entries.size() + m_legacy_items.size(); }
+
+std::pair<double, double> SceneFile::Index::get_center(size_t i) const
+{
+    if (!m_legacy_items.empty())
+        return {m_legacy_items[i].x, m_legacy_items[i].y};
+    return {m_entries[i].x, m_entries[i].y};
+}
+
+std::expected<FiniteAutomaton, std::string> SceneFile::Index::load(size_t i) const
+{
+    if (!m_legacy_items.empty())
+        return m_legacy_items[i].automaton;
+    return FiniteAutomaton::deserialize(m_entries[i].data);
+}
+
+std::string_view SceneFile::Index::get_data(size_t i) const
+{
+    return m_legacy_items.empty() ? m_entries[i].data : std::string_view();
+}
+
+std::expected<std::vector<SceneFile::Item>, std::string> SceneFile::read(std::string_view contents)
+{
+    auto index = Index::read(contents);
+    if (!index)
+        return std::unexpected(index.error());
+
+    std::vector<Item> items;
+    for (size_t i = 0; i < index->size(); ++i) {
+        auto automaton = index->load(i);
+        if (!automaton)
+            return std::unexpected(automaton.error());
+        const auto [x, y] = index->get_center(i);
+        items.push_back({std::move(*automaton), x, y});
+    }
+
+    return items;
+}
+
+std::string SceneFile::write(std::span<const Item> items, std::span<const RawItem> raw_items)
+{
+    // Identical automata are stored once, with all of their entries pointing to the same data. Automata which
+    // only accept the same language are kept apart, since the scene shows them as they were built.
+    std::unordered_map<std::string, size_t> data_ids;
+    std::vector<const std::string *> data;
+    std::vector<size_t> item_data_ids;
+    const auto add_data = [&](std::string item_data) {
+        auto [it, inserted] = data_ids.try_emplace(std::move(item_data), data.size());
+        if (inserted)
+            data.push_back(&it->first);
+        item_data_ids.push_back(it->second);
+    };
+    std::vector<std::pair<double, double>> centers;
+    for (const auto &item : items) {
+        add_data(item.automaton.serialize());
+        centers.push_back({item.x, item.y});
+    }
+    for (const auto &raw_item : raw_items) {
+        add_data(raw_item.data);
+        centers.push_back({raw_item.x, raw_item.y});
+    }
+
+    std::string contents(scene_magic);
+    contents += static_cast<char>(scene_version);
+    append_little_endian<std::uint64_t>(contents, centers.size());
+
+    std::vector<std::uint64_t> offsets;
+    std::uint64_t offset = contents.size() + centers.size() * toc_entry_size;
+    for (const auto &automaton_data : data) {
+        offsets.push_back(offset);
+        offset += automaton_data->size();
+    }
+
+    for (size_t i = 0; i < centers.size(); ++i) {
+        append_little_endian(contents, offsets[item_data_ids[i]]);
+        append_little_endian<std::uint64_t>(contents, data[item_data_ids[i]]->size());
+        append_little_endian(contents, centers[i].first);
+        append_little_endian(contents, centers[i].second);
+    }
+    for (const auto &automaton_data : data)
+        contents += *automaton_data;
+
+    return contents;
+}
+
+std::expected<std::vector<FiniteAutomaton>, std::string> SceneFile::read_regexes(std::string_view contents)
+{
+    std::vector<FiniteAutomaton> automata;
+
+    for (size_t line_number = 1; !contents.empty(); ++line_number) {
+        const auto line_end = std::min(contents.find('\n'), contents.size());
+        auto line = contents.substr(0, line_end);
+        contents.remove_prefix(std::min(line_end + 1, contents.size()));
+
+        if (line.ends_with('\r'))
+            line.remove_suffix(1);
+        if (line.empty())
+            continue;
+
+        auto automaton = FiniteAutomaton::construct(std::string(line));
+        if (!automaton)
+            return std::unexpected(automaton.error() + " on line " + std::to_string(line_number));
+        automata.push_back(std::move(*automaton));
+    }
+
+    return automata;
+}
@@ -0,0 +1,70 @@
+#ifndef SCENE_FILE_HPP
+#define SCENE_FILE_HPP
+
+#include "finite_automaton.hpp"
+
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Reading and writing of the files the GUI saves its scenes to (*.fat), without depending on Qt.
+// Scenes are written in a versioned format, which starts with a table of contents giving the center of
+// each automaton on the scene, along with where its serialized form is in the file. The scenes saved
+// before versioning, which QDataStream wrote, can still be read: their format is followed byte for byte
+// (big-endian integers, containers prefixed with their 32-bit size, and each center stored after its
+// automaton as a pair of doubles).
+namespace SceneFile {
+struct Item
+{
+    FiniteAutomaton automaton;
+    double x = 0, y = 0;
+};
+
+// An automaton in its serialized form, written back as it is, e.g. one which failed to load, so that saving
+// doesn't lose it.
+struct RawItem
+{
+    std::string data;
+    double x = 0, y = 0;
+};
+
+// Table of contents of a scene, read without decoding any of its automata, so that each one can be decoded
+// separately, when needed. The contents the index is read from must outlive it.
+class Index
+{
+  public:
+    static std::expected<Index, std::string> read(std::string_view contents);
+
+    size_t size() const;
+    // The center of the automaton on the scene.
+    std::pair<double, double> get_center(size_t i) const;
+    std::expected<FiniteAutomaton, std::string> load(size_t i) const;
+    // The serialized form of the automaton, which is empty for scenes saved before versioning (those are
+    // decoded as a whole when read).
+    std::string_view get_data(size_t i) const;
+
+  private:
+    Index() = default;
+
+    struct Entry
+    {
+        std::string_view data;
+        double x, y;
+    };
+    std::vector<Entry> m_entries;
+    // Scenes saved before versioning have no table of contents, so they are decoded right away.
+    std::vector<Item> m_legacy_items;
+};
+
+std::expected<std::vector<Item>, std::string> read(std::string_view contents);
+// The raw items follow the others.
+std::string write(std::span<const Item> items, std::span<const RawItem> raw_items = {});
+
+// Text files hold one regex per line, empty lines being skipped.
+std::expected<std::vector<FiniteAutomaton>, std::string> read_regexes(std::string_view contents);
+} // namespace SceneFile
+
+#endif // SCENE_FILE_HPP
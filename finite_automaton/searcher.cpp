@@ -0,0 +1,118 @@
+#include "searcher.hpp"
+
+#include <algorithm>
+
+namespace {
+// Automaton accepting every word that ends with a word accepted by the given automaton.
+FiniteAutomaton with_any_prefix(const FiniteAutomaton &automaton)
+{
+    const auto &states = automaton.get_states();
+    const unsigned prefix_state = states.empty() ? 0 : *std::ranges::max_element(states) + 1;
+
+    auto extended_states = states;
+    extended_states.insert(prefix_state);
+
+    auto transition_function = automaton.get_transition_function();
+    for (const auto &symbol : automaton.get_alphabet())
+        transition_function[{prefix_state, symbol}].insert(prefix_state);
+    transition_function[{prefix_state, FiniteAutomaton::epsilon_transition_value}].insert(
+        automaton.get_initial_states().begin(), automaton.get_initial_states().end());
+
+    return *FiniteAutomaton::construct(
+        automaton.get_alphabet(), std::move(extended_states), {prefix_state}, automaton.get_final_states(),
+        std::move(transition_function));
+}
+
+// Transition of an unanchored table. Symbols outside of the alphabet kill every partial match, which
+// only leaves the initial state, since only they lead an unanchored automaton to the dead state.
+unsigned next_unanchored(const DfaTable &table, unsigned state, char symbol)
+{
+    // Selecting arithmetically keeps the compiler from branching, which would be mispredicted as often
+    // as foreign symbols (e.g. separators in a log line) come and go.
+    state = table.next(state, symbol);
+    const unsigned is_dead = state == table.get_dead_state();
+    return state ^ (-is_dead & (state ^ table.get_initial_state()));
+}
+} // namespace
+
+Searcher::Searcher(const FiniteAutomaton &automaton)
+    : m_forward(automaton.minimize()), m_unanchored_forward(with_any_prefix(automaton).minimize()),
+      m_reverse(automaton.reverse().minimize()), m_unanchored_reverse(with_any_prefix(automaton.reverse()).minimize())
+{
+}
+
+std::optional<Searcher::match_t> Searcher::find_first(std::string_view text) const
+{
+    return find_first_from(text, 0, true);
+}
+
+std::vector<Searcher::match_t> Searcher::find_all(std::string_view text) const
+{
+    std::vector<match_t> matches;
+
+    size_t from = 0;
+    bool allow_empty_at_from = true;
+    while (auto match = find_first_from(text, from, allow_empty_at_from)) {
+        matches.push_back(*match);
+        from = match->second;
+        allow_empty_at_from = false;
+    }
+
+    return matches;
+}
+
+std::optional<Searcher::match_t> Searcher::find_longest(std::string_view text) const
+{
+    // Every start of a match is found by scanning the whole text backward, so the last one is the leftmost.
+    auto state = m_unanchored_reverse.get_initial_state();
+    std::optional<size_t> begin;
+    if (m_unanchored_reverse.is_final(state))
+        begin = text.size();
+    for (size_t i = text.size(); i > 0; --i) {
+        state = next_unanchored(m_unanchored_reverse, state, text[i - 1]);
+        if (m_unanchored_reverse.is_final(state))
+            begin = i - 1;
+    }
+
+    if (!begin)
+        return std::nullopt;
+
+    // From the start on, the longest match is found by scanning forward until the automaton dies.
+    state = m_forward.get_initial_state();
+    size_t end = *begin;
+    for (size_t i = *begin; i < text.size() && state != m_forward.get_dead_state(); ++i) {
+        state = m_forward.next(state, text[i]);
+        if (m_forward.is_final(state))
+            end = i + 1;
+    }
+
+    return match_t{*begin, end};
+}
+
+std::optional<Searcher::match_t>
+Searcher::find_first_from(std::string_view text, size_t from, bool allow_empty_at_from) const
+{
+    auto state = m_unanchored_forward.get_initial_state();
+    std::optional<size_t> end;
+    if (allow_empty_at_from && m_unanchored_forward.is_final(state))
+        end = from;
+    for (size_t i = from; i < text.size() && !end; ++i) {
+        state = next_unanchored(m_unanchored_forward, state, text[i]);
+        if (m_unanchored_forward.is_final(state))
+            end = i + 1;
+    }
+
+    if (!end)
+        return std::nullopt;
+
+    // A match ends here, so scanning backward finds its leftmost start, which can't precede the scan.
+    state = m_reverse.get_initial_state();
+    size_t begin = *end;
+    for (size_t i = *end; i > from && state != m_reverse.get_dead_state(); --i) {
+        state = m_reverse.next(state, text[i - 1]);
+        if (m_reverse.is_final(state))
+            begin = i - 1;
+    }
+
+    return match_t{begin, *end};
+}
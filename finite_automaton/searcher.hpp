@@ -0,0 +1,39 @@
+#ifndef SEARCHER_HPP
+#define SEARCHER_HPP
+
+#include "dfa_table.hpp"
+#include "finite_automaton.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Finds the occurrences of the words accepted by an automaton inside of a text, as [begin, end) offsets.
+// Match ends are found by scanning forward with an automaton accepting every text that ends with a
+// match, and match starts by scanning backward from a known end with the reversed automaton, so every
+// search takes time linear in the text, without ever backtracking.
+class Searcher
+{
+  public:
+    using match_t = std::pair<size_t, size_t>;
+
+    explicit Searcher(const FiniteAutomaton &automaton);
+
+    // The match that ends first, starting as far left as possible.
+    std::optional<match_t> find_first(std::string_view text) const;
+    // All non-overlapping matches, each of them found as the first one after the end of the previous one.
+    // An empty match is never reported where the previous match has ended.
+    std::vector<match_t> find_all(std::string_view text) const;
+    // The match that starts first, ending as far right as possible (i.e. the leftmost-longest match).
+    std::optional<match_t> find_longest(std::string_view text) const;
+
+  private:
+    std::optional<match_t> find_first_from(std::string_view text, size_t from, bool allow_empty_at_from) const;
+
+    DfaTable m_forward, m_unanchored_forward;
+    DfaTable m_reverse, m_unanchored_reverse;
+};
+
+#endif // SEARCHER_HPP
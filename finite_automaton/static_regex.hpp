@@ -0,0 +1,369 @@
+#ifndef STATIC_REGEX_HPP
+#define STATIC_REGEX_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// A regex compiled into a minimal DFA entirely at compile time, for patterns which are known
+// when the program is built:
+//
+//     using identifier = fat::static_regex<"(a|b|_)(a|b|_|0|1)*">;
+//     static_assert(identifier::accepts("a_0"));
+//
+// The syntax is the same as that of FiniteAutomaton::construct, and so is the language, but
+// nothing is left to do at run time: the table is a constant and matching is a loop over it.
+// An invalid pattern is a compile error.
+namespace fat {
+template <size_t N> struct fixed_string
+{
+    constexpr fixed_string(const char (&string)[N]) { std::copy_n(string, N, symbols); }
+    constexpr std::string_view view() const { return {symbols, N - 1}; }
+
+    char symbols[N]{};
+};
+
+namespace detail {
+inline constexpr char epsilon = '~';
+
+struct nfa_transition
+{
+    unsigned from;
+    char symbol;
+    unsigned to;
+};
+
+struct nfa_fragment
+{
+    unsigned start, end;
+};
+
+// Recursive descent over the grammar of RegexDriver, building a Thompson automaton on the way.
+class nfa_builder
+{
+  public:
+    constexpr explicit nfa_builder(std::string_view regex) : m_regex(regex) {}
+
+    constexpr bool build()
+    {
+        const auto fragment = parse_alternation();
+        if (!m_valid || m_position != m_regex.size())
+            return false;
+        initial_state = fragment.start;
+        final_state = fragment.end;
+        return true;
+    }
+
+    std::vector<nfa_transition> transitions;
+    unsigned num_of_states = 0;
+    unsigned initial_state = 0, final_state = 0;
+
+  private:
+    static constexpr bool is_operator(char symbol)
+    {
+        return std::string_view("|?*+()").find(symbol) != std::string_view::npos;
+    }
+
+    constexpr unsigned add_state() { return num_of_states++; }
+    constexpr void add_transition(unsigned from, char symbol, unsigned to) { transitions.push_back({from, symbol, to}); }
+    constexpr bool peek(char symbol) const { return m_position < m_regex.size() && m_regex[m_position] == symbol; }
+
+    constexpr nfa_fragment parse_alternation()
+    {
+        auto left = parse_concatenation();
+        while (m_valid && peek('|')) {
+            ++m_position;
+            const auto right = parse_concatenation();
+            const nfa_fragment fragment = {add_state(), add_state()};
+            add_transition(fragment.start, epsilon, left.start);
+            add_transition(fragment.start, epsilon, right.start);
+            add_transition(left.end, epsilon, fragment.end);
+            add_transition(right.end, epsilon, fragment.end);
+            left = fragment;
+        }
+        return left;
+    }
+
+    constexpr nfa_fragment parse_concatenation()
+    {
+        auto left = parse_unary();
+        while (m_valid && m_position < m_regex.size() && !peek('|') && !peek(')')) {
+            const auto right = parse_unary();
+            add_transition(left.end, epsilon, right.start);
+            left.end = right.end;
+        }
+        return left;
+    }
+
+    constexpr nfa_fragment parse_unary()
+    {
+        const auto operand = parse_base();
+        if (!m_valid || m_position == m_regex.size())
+            return operand;
+
+        const auto op = m_regex[m_position];
+        if (op != '?' && op != '*' && op != '+')
+            return operand;
+        ++m_position;
+
+        const nfa_fragment fragment = {add_state(), add_state()};
+        add_transition(fragment.start, epsilon, operand.start);
+        add_transition(operand.end, epsilon, fragment.end);
+        if (op != '+')
+            add_transition(fragment.start, epsilon, fragment.end);
+        if (op != '?')
+            add_transition(operand.end, epsilon, operand.start);
+        return fragment;
+    }
+
+    constexpr nfa_fragment parse_base()
+    {
+        if (peek('(')) {
+            ++m_position;
+            const auto fragment = parse_alternation();
+            if (!peek(')'))
+                m_valid = false;
+            ++m_position;
+            return fragment;
+        }
+
+        if (m_position == m_regex.size() || is_operator(m_regex[m_position])) {
+            m_valid = false;
+            return {};
+        }
+
+        const nfa_fragment fragment = {add_state(), add_state()};
+        add_transition(fragment.start, m_regex[m_position++], fragment.end);
+        return fragment;
+    }
+
+    std::string_view m_regex;
+    size_t m_position = 0;
+    bool m_valid = true;
+};
+
+// A complete minimal DFA, laid out like DfaTable: class 0 holds the symbols outside of the alphabet,
+// the initial state is 0 and there is always a dead state, which is the last one.
+struct dfa
+{
+    bool valid = false;
+    unsigned num_of_states = 0, num_of_classes = 0;
+    std::array<unsigned, 256> classes{};
+    std::vector<unsigned> transitions;
+    std::vector<char> final;
+};
+
+// The states reachable from each state through epsilon transitions alone, itself included.
+constexpr std::vector<std::vector<unsigned>> epsilon_closures(const nfa_builder &nfa)
+{
+    std::vector<std::vector<unsigned>> successors(nfa.num_of_states);
+    for (const auto &transition : nfa.transitions) {
+        if (transition.symbol == epsilon)
+            successors[transition.from].push_back(transition.to);
+    }
+
+    std::vector<std::vector<unsigned>> closures(nfa.num_of_states);
+    // The last state whose closure each state was added to.
+    std::vector<unsigned> visited(nfa.num_of_states, nfa.num_of_states);
+    for (unsigned state = 0; state < nfa.num_of_states; ++state) {
+        auto &closure = closures[state];
+        closure.push_back(state);
+        visited[state] = state;
+        for (size_t i = 0; i < closure.size(); ++i) {
+            for (const auto &to_state : successors[closure[i]]) {
+                if (visited[to_state] != state) {
+                    visited[to_state] = state;
+                    closure.push_back(to_state);
+                }
+            }
+        }
+    }
+    return closures;
+}
+
+constexpr dfa compile(std::string_view regex)
+{
+    nfa_builder nfa(regex);
+    dfa result;
+    if (!nfa.build())
+        return result;
+
+    std::vector<char> alphabet;
+    for (const auto &transition : nfa.transitions) {
+        if (transition.symbol != epsilon && std::ranges::find(alphabet, transition.symbol) == alphabet.end())
+            alphabet.push_back(transition.symbol);
+    }
+    const auto num_of_symbols = alphabet.size();
+
+    // Every state of a Thompson automaton reads at most one symbol.
+    const auto closures = epsilon_closures(nfa);
+    std::vector<unsigned> symbol_indices(nfa.num_of_states, num_of_symbols), symbol_targets(nfa.num_of_states);
+    for (const auto &transition : nfa.transitions) {
+        if (transition.symbol != epsilon) {
+            symbol_indices[transition.from] = std::ranges::find(alphabet, transition.symbol) - alphabet.begin();
+            symbol_targets[transition.from] = transition.to;
+        }
+    }
+
+    // Subset construction over sorted lists of states, with the empty set first so that there is
+    // a dead state even when every symbol of the alphabet can be read from every state.
+    std::vector<std::vector<unsigned>> subsets = {{}, closures[nfa.initial_state]};
+    std::ranges::sort(subsets[1]);
+
+    std::vector<unsigned> subset_transitions;
+    std::vector<std::vector<char>> to_subsets(num_of_symbols, std::vector<char>(nfa.num_of_states, false));
+    for (size_t i = 0; i < subsets.size(); ++i) {
+        for (const auto &state : subsets[i]) {
+            if (symbol_indices[state] == num_of_symbols)
+                continue;
+            for (const auto &to_state : closures[symbol_targets[state]])
+                to_subsets[symbol_indices[state]][to_state] = true;
+        }
+
+        for (auto &to_states : to_subsets) {
+            std::vector<unsigned> subset;
+            for (unsigned state = 0; state < nfa.num_of_states; ++state) {
+                if (to_states[state])
+                    subset.push_back(state);
+            }
+            std::ranges::fill(to_states, false);
+
+            auto it = std::ranges::find(subsets, subset);
+            subset_transitions.push_back(it - subsets.begin());
+            if (it == subsets.end())
+                subsets.push_back(std::move(subset));
+        }
+    }
+    const auto num_of_subsets = subsets.size();
+
+    // Moore's partition refinement, starting from final and non-final states.
+    std::vector<unsigned> blocks(num_of_subsets);
+    for (size_t i = 0; i < num_of_subsets; ++i)
+        blocks[i] = std::ranges::binary_search(subsets[i], nfa.final_state);
+    for (unsigned num_of_blocks = 0;;) {
+        std::vector<std::vector<unsigned>> signatures;
+        std::vector<unsigned> new_blocks(num_of_subsets);
+        for (size_t i = 0; i < num_of_subsets; ++i) {
+            std::vector<unsigned> signature = {blocks[i]};
+            for (size_t symbol = 0; symbol < num_of_symbols; ++symbol)
+                signature.push_back(blocks[subset_transitions[i * num_of_symbols + symbol]]);
+
+            auto it = std::ranges::find(signatures, signature);
+            new_blocks[i] = it - signatures.begin();
+            if (it == signatures.end())
+                signatures.push_back(std::move(signature));
+        }
+        blocks = std::move(new_blocks);
+        if (signatures.size() == num_of_blocks)
+            break;
+        num_of_blocks = signatures.size();
+    }
+
+    // Blocks are renumbered by first visit, with the initial state first and the dead state last.
+    const unsigned unnumbered = std::numeric_limits<unsigned>::max();
+    std::vector<unsigned> state_ids(num_of_subsets, unnumbered);
+    std::vector<unsigned> representatives;
+    for (size_t i = 1; i < num_of_subsets; ++i) {
+        if (blocks[i] != blocks[0] && state_ids[blocks[i]] == unnumbered) {
+            state_ids[blocks[i]] = representatives.size();
+            representatives.push_back(i);
+        }
+    }
+    const unsigned dead_state = representatives.size();
+    state_ids[blocks[0]] = dead_state;
+    representatives.push_back(0);
+    result.num_of_states = representatives.size();
+
+    // Symbols with the same column of target states form a class.
+    std::vector<std::vector<unsigned>> columns = {std::vector<unsigned>(result.num_of_states, dead_state)};
+    for (size_t symbol = 0; symbol < num_of_symbols; ++symbol) {
+        std::vector<unsigned> column;
+        for (const auto &subset : representatives)
+            column.push_back(state_ids[blocks[subset_transitions[subset * num_of_symbols + symbol]]]);
+
+        auto it = std::ranges::find(columns, column);
+        result.classes[static_cast<unsigned char>(alphabet[symbol])] = it - columns.begin();
+        if (it == columns.end())
+            columns.push_back(std::move(column));
+    }
+    result.num_of_classes = columns.size();
+
+    result.transitions.assign(result.num_of_states * result.num_of_classes, dead_state);
+    for (unsigned symbol_class = 0; symbol_class < result.num_of_classes; ++symbol_class) {
+        for (unsigned state = 0; state < result.num_of_states; ++state)
+            result.transitions[state * result.num_of_classes + symbol_class] = columns[symbol_class][state];
+    }
+
+    for (const auto &subset : representatives)
+        result.final.push_back(std::ranges::binary_search(subsets[subset], nfa.final_state));
+
+    result.valid = true;
+    return result;
+}
+
+template <size_t NumOfStates>
+using state_t = std::conditional_t<NumOfStates <= std::numeric_limits<uint8_t>::max() + 1, uint8_t,
+                                   std::conditional_t<NumOfStates <= std::numeric_limits<uint16_t>::max() + 1,
+                                                      uint16_t, uint32_t>>;
+} // namespace detail
+
+template <fixed_string Pattern> class static_regex
+{
+  public:
+    static constexpr std::string_view pattern = Pattern.view();
+
+  private:
+    // The automaton can't outlive the constant evaluation which builds it, so it is built twice:
+    // once for the sizes of the tables, then once more to fill them in.
+    static constexpr auto m_sizes = [] {
+        const auto automaton = detail::compile(pattern);
+        return std::array<unsigned, 3>{automaton.valid, automaton.num_of_states, automaton.num_of_classes};
+    }();
+    static_assert(m_sizes[0], "Regex parsing error");
+
+  public:
+    static constexpr unsigned num_of_states = m_sizes[1];
+    static constexpr unsigned num_of_classes = m_sizes[2];
+    static constexpr unsigned initial_state = 0;
+    static constexpr unsigned dead_state = num_of_states - 1;
+
+    static constexpr bool accepts(std::string_view word)
+    {
+        unsigned state = initial_state;
+        for (const auto &symbol : word) {
+            state = m_transitions[state * num_of_classes + m_classes[static_cast<unsigned char>(symbol)]];
+            if (state == dead_state)
+                return false;
+        }
+        return m_final[state];
+    }
+
+  private:
+    using state_t = detail::state_t<num_of_states>;
+
+    static constexpr auto m_automaton = [] {
+        const auto automaton = detail::compile(pattern);
+
+        struct
+        {
+            std::array<uint8_t, 256> classes{};
+            std::array<state_t, num_of_states * num_of_classes> transitions{};
+            std::array<bool, num_of_states> final{};
+        } tables;
+        std::ranges::copy(automaton.classes, tables.classes.begin());
+        std::ranges::copy(automaton.transitions, tables.transitions.begin());
+        std::ranges::copy(automaton.final, tables.final.begin());
+        return tables;
+    }();
+    static constexpr const auto &m_classes = m_automaton.classes;
+    static constexpr const auto &m_transitions = m_automaton.transitions;
+    static constexpr const auto &m_final = m_automaton.final;
+};
+} // namespace fat
+
+#endif // STATIC_REGEX_HPP
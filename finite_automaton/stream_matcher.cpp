@@ -0,0 +1,33 @@
+#include "stream_matcher.hpp"
+
+StreamMatcher::StreamMatcher(const FiniteAutomaton &automaton)
+    : StreamMatcher(std::make_shared<const DfaTable>(automaton.minimize()))
+{
+}
+
+StreamMatcher::StreamMatcher(std::shared_ptr<const DfaTable> table)
+    : m_table(std::move(table)), m_state(m_table->get_initial_state())
+{
+}
+
+void StreamMatcher::feed(std::string_view chunk)
+{
+    const auto &table = *m_table;
+    const auto dead_state = table.get_dead_state();
+
+    auto state = m_state;
+    for (const auto &symbol : chunk) {
+        if (state == dead_state)
+            break;
+        state = table.next(state, symbol);
+    }
+    m_state = state;
+}
+
+void StreamMatcher::reset() { m_state = m_table->get_initial_state(); }
+
+bool StreamMatcher::is_accepting() const { return m_table->is_final(m_state); }
+
+bool StreamMatcher::is_dead() const { return m_state == m_table->get_dead_state(); }
+
+const std::shared_ptr<const DfaTable> &StreamMatcher::get_table() const { return m_table; }
@@ -0,0 +1,34 @@
+#ifndef STREAM_MATCHER_HPP
+#define STREAM_MATCHER_HPP
+
+#include "dfa_table.hpp"
+#include "finite_automaton.hpp"
+
+#include <memory>
+#include <string_view>
+
+// Matches a word arriving in chunks of any size, without ever needing the whole word at once.
+// The compiled table is immutable, so it can be shared among matchers running on separate streams.
+class StreamMatcher
+{
+  public:
+    explicit StreamMatcher(const FiniteAutomaton &automaton);
+    explicit StreamMatcher(std::shared_ptr<const DfaTable> table);
+
+    void feed(std::string_view chunk);
+    void reset();
+
+    // Whether the input fed so far is accepted.
+    bool is_accepting() const;
+    // Whether no continuation of the input fed so far can be accepted anymore,
+    // in which case the rest of the stream doesn't have to be fed at all.
+    bool is_dead() const;
+
+    const std::shared_ptr<const DfaTable> &get_table() const;
+
+  private:
+    std::shared_ptr<const DfaTable> m_table;
+    unsigned m_state;
+};
+
+#endif // STREAM_MATCHER_HPP
@@ -0,0 +1,180 @@
+#include "threaded_matcher.hpp"
+
+#include <optional>
+
+ThreadedMatcher::ThreadedMatcher(const FiniteAutomaton &automaton) : ThreadedMatcher(DfaTable(automaton)) {}
+
+ThreadedMatcher::ThreadedMatcher(const DfaTable &table)
+{
+    const auto num_of_classes = table.get_num_of_classes();
+    const auto dead_state = table.get_dead_state();
+    m_initial_state = table.get_initial_state();
+
+    std::optional<char> foreign_symbol;
+    for (unsigned symbol = 0; symbol < 256; ++symbol) {
+        m_classes[symbol] = table.get_class(static_cast<char>(symbol));
+        if (m_classes[symbol] == 0 && !foreign_symbol)
+            foreign_symbol = static_cast<char>(symbol);
+    }
+    // Symbols which lead somewhere from some state.
+    std::string alphabet;
+    for (const auto &symbol : table.get_alphabet()) {
+        if (table.get_class(symbol) != 0)
+            alphabet += symbol;
+    }
+
+    // Instructions are numbered as the states of the table, the dead state included.
+    m_code.resize(table.get_num_of_states());
+    m_code[dead_state].opcode = Opcode::Fail;
+    for (unsigned state = 0; state < dead_state; ++state) {
+        auto &instruction = m_code[state];
+        instruction.final = table.is_final(state);
+
+        std::string live_symbols;
+        for (const auto &symbol : alphabet) {
+            if (table.next(state, symbol) != dead_state)
+                live_symbols += symbol;
+        }
+
+        if (live_symbols.empty()) {
+            // A live state which can't lead to a final state is final itself.
+            instruction.opcode = Opcode::Match;
+            continue;
+        }
+
+        if (live_symbols.size() == 1) {
+            instruction.symbol = live_symbols[0];
+            instruction.next = table.next(state, instruction.symbol);
+            instruction.opcode = instruction.next == state ? Opcode::SingleLoop : Opcode::Single;
+            continue;
+        }
+
+        // The common target is that of the first two symbols which agree, with the exception being the
+        // symbol which disagrees with it. When all symbols agree, a foreign symbol is the exception.
+        const auto first = table.next(state, alphabet[0]), second = table.next(state, alphabet[1]);
+        const auto common = first == second || alphabet.size() == 2 ? first : table.next(state, alphabet[2]);
+        std::optional<char> exception;
+        bool all_but_one = true;
+        for (const auto &symbol : alphabet) {
+            if (table.next(state, symbol) == common)
+                continue;
+            all_but_one = all_but_one && !exception;
+            exception = symbol;
+        }
+        if (!exception)
+            exception = foreign_symbol;
+
+        if (common != dead_state && all_but_one && exception) {
+            instruction.symbol = *exception;
+            instruction.next = common;
+            instruction.other = table.next(state, *exception);
+            instruction.opcode = common == state ? Opcode::AllButOneLoop : Opcode::AllButOne;
+            continue;
+        }
+
+        instruction.opcode = Opcode::Table;
+        instruction.other = m_rows.size();
+        for (unsigned symbol_class = 0; symbol_class < num_of_classes; ++symbol_class)
+            m_rows.push_back(table.next_by_class(state, symbol_class));
+    }
+
+    const void *const *handlers = nullptr;
+    execute({}, &handlers);
+    if (handlers) {
+        for (auto &instruction : m_code)
+            instruction.handler = handlers[static_cast<size_t>(instruction.opcode)];
+    }
+}
+
+bool ThreadedMatcher::accepts(std::string_view word) const { return execute(word); }
+
+bool ThreadedMatcher::execute(std::string_view word, const void *const **handlers) const
+{
+#if defined(__GNUC__)
+    static const void *const opcode_handlers[] = {
+        &&fail, &&match, &&single, &&single_loop, &&all_but_one, &&all_but_one_loop, &&table,
+    };
+#define DISPATCH() goto *instruction->handler
+#else
+    static const void *const *const opcode_handlers = nullptr;
+#define DISPATCH()                                                                                                     \
+    switch (instruction->opcode) {                                                                                     \
+    case Opcode::Fail:                                                                                                 \
+        goto fail;                                                                                                     \
+    case Opcode::Match:                                                                                                \
+        goto match;                                                                                                    \
+    case Opcode::Single:                                                                                               \
+        goto single;                                                                                                   \
+    case Opcode::SingleLoop:                                                                                           \
+        goto single_loop;                                                                                              \
+    case Opcode::AllButOne:                                                                                            \
+        goto all_but_one;                                                                                              \
+    case Opcode::AllButOneLoop:                                                                                        \
+        goto all_but_one_loop;                                                                                         \
+    case Opcode::Table:                                                                                                \
+        goto table;                                                                                                    \
+    }                                                                                                                  \
+    return false
+#endif
+
+    if (handlers) {
+        *handlers = opcode_handlers;
+        return false;
+    }
+
+    const auto symbol_class = [&](char symbol) { return m_classes[static_cast<unsigned char>(symbol)]; };
+    const auto *code = m_code.data();
+    const auto *rows = m_rows.data();
+    const char *it = word.data(), *const end = it + word.size();
+    const Instruction *instruction = code + m_initial_state;
+    DISPATCH();
+
+fail:
+    return false;
+
+match:
+    return it == end;
+
+single:
+    if (it == end)
+        return instruction->final;
+    if (*it++ != instruction->symbol)
+        return false;
+    instruction = code + instruction->next;
+    DISPATCH();
+
+single_loop:
+    while (it != end && *it == instruction->symbol)
+        ++it;
+    return it == end && instruction->final;
+
+all_but_one:
+    if (it == end)
+        return instruction->final;
+    if (*it == instruction->symbol)
+        instruction = code + instruction->other;
+    else if (symbol_class(*it) != 0)
+        instruction = code + instruction->next;
+    else
+        return false;
+    ++it;
+    DISPATCH();
+
+all_but_one_loop:
+    while (it != end && *it != instruction->symbol && symbol_class(*it) != 0)
+        ++it;
+    if (it == end)
+        return instruction->final;
+    if (*it++ != instruction->symbol)
+        return false;
+    instruction = code + instruction->other;
+    DISPATCH();
+
+table:
+    if (it == end)
+        return instruction->final;
+    instruction = code + rows[instruction->other + symbol_class(*it++)];
+    DISPATCH();
+
+#undef DISPATCH
+}
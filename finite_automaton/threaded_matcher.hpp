@@ -0,0 +1,67 @@
+#ifndef THREADED_MATCHER_HPP
+#define THREADED_MATCHER_HPP
+
+#include "dfa_table.hpp"
+#include "finite_automaton.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Alternative to DfaTable::accepts, which lowers the table into a stream of one instruction per state and
+// interprets it with direct threading (each instruction holds the address of the code handling it, jumped to
+// by computed goto where the compiler supports it, and a switch elsewhere).
+//
+// Sparse states get specialized instructions which don't touch the table at all: states with a single
+// outgoing symbol, states in which all symbols of the alphabet but one lead to the same state, and self-loops
+// of either kind, which consume a whole run of symbols at once. Only the remaining states keep their rows,
+// so long chains of sparse states, as in automata of keywords and rules, take little cache.
+class ThreadedMatcher
+{
+  public:
+    // Non-deterministic automata are determinized first.
+    explicit ThreadedMatcher(const FiniteAutomaton &automaton);
+    explicit ThreadedMatcher(const DfaTable &table);
+
+    bool accepts(std::string_view word) const;
+
+  private:
+    enum class Opcode : std::uint8_t
+    {
+        // The dead state.
+        Fail,
+        // A final state with no outgoing transitions.
+        Match,
+        // Only `symbol` leads out, to `next`.
+        Single,
+        // Only `symbol` leads out, back to the same state.
+        SingleLoop,
+        // Every symbol of the alphabet other than `symbol` leads to `next`, while `symbol` leads to `other`.
+        AllButOne,
+        // As AllButOne, where `next` is the same state.
+        AllButOneLoop,
+        // The targets are looked up in the row of the state, starting at `other` in m_rows.
+        Table,
+    };
+
+    struct Instruction
+    {
+        const void *handler = nullptr;
+        Opcode opcode;
+        bool final = false;
+        char symbol = 0;
+        unsigned next = 0, other = 0;
+    };
+
+    // When given where to, only writes out the addresses of the handlers of the opcodes, in the order of
+    // the enumeration (or nullptr without computed goto), since they are only known inside the function.
+    bool execute(std::string_view word, const void *const **handlers = nullptr) const;
+
+    std::array<std::uint16_t, 256> m_classes{};
+    unsigned m_initial_state;
+    std::vector<Instruction> m_code;
+    std::vector<unsigned> m_rows;
+};
+
+#endif // THREADED_MATCHER_HPP
@@ -0,0 +1,75 @@
+#include "transition_graph.hpp"
+
+#include <algorithm>
+
+TransitionGraph::TransitionGraph(const FiniteAutomaton &automaton)
+    : m_original_states(automaton.get_states().begin(), automaton.get_states().end())
+{
+    const auto &transition_function = automaton.get_transition_function();
+    const bool dense = automaton.has_dense_states();
+
+    // The transition function is sorted by source state and then by symbol, just as the edges are.
+    m_offsets.assign(m_original_states.size() + 1, 0);
+    for (const auto &[k, v] : transition_function)
+        m_offsets[*get_state(k.first) + 1] += v.size();
+    for (size_t state = 0; state < m_original_states.size(); ++state)
+        m_offsets[state + 1] += m_offsets[state];
+
+    m_edges.reserve(m_offsets.back());
+    for (const auto &[k, v] : transition_function) {
+        for (const auto &to_state : v)
+            m_edges.push_back({k.second, dense ? to_state : *get_state(to_state)});
+    }
+}
+
+std::optional<unsigned> TransitionGraph::get_state(unsigned original_state) const
+{
+    // Dense states are their own numbers.
+    if (m_original_states.empty() || m_original_states.back() == m_original_states.size() - 1)
+        return original_state < m_original_states.size() ? std::optional(original_state) : std::nullopt;
+
+    auto it = std::ranges::lower_bound(m_original_states, original_state);
+    if (it == m_original_states.end() || *it != original_state)
+        return std::nullopt;
+    return it - m_original_states.begin();
+}
+
+std::span<const TransitionGraph::Edge> TransitionGraph::predecessors(unsigned state) const
+{
+    std::call_once(m_predecessors_built, [this]() {
+        const auto num_of_states = get_num_of_states();
+
+        m_predecessor_offsets.assign(num_of_states + 1, 0);
+        for (const auto &edge : m_edges)
+            ++m_predecessor_offsets[edge.state + 1];
+        for (unsigned to_state = 0; to_state < num_of_states; ++to_state)
+            m_predecessor_offsets[to_state + 1] += m_predecessor_offsets[to_state];
+
+        // Distributing the edges by target keeps them sorted by source, and a stable sort by symbol then
+        // gives the order of the outgoing edges.
+        std::vector<unsigned> positions(m_predecessor_offsets.begin(), m_predecessor_offsets.end() - 1);
+        m_predecessor_edges.resize(m_edges.size());
+        for (unsigned from_state = 0; from_state < num_of_states; ++from_state) {
+            for (const auto &edge : successors(from_state))
+                m_predecessor_edges[positions[edge.state]++] = {edge.symbol, from_state};
+        }
+        for (unsigned to_state = 0; to_state < num_of_states; ++to_state) {
+            std::ranges::stable_sort(
+                m_predecessor_edges.begin() + m_predecessor_offsets[to_state],
+                m_predecessor_edges.begin() + m_predecessor_offsets[to_state + 1], {}, &Edge::symbol);
+        }
+    });
+
+    return {
+        m_predecessor_edges.data() + m_predecessor_offsets[state],
+        m_predecessor_edges.data() + m_predecessor_offsets[state + 1]};
+}
+
+std::optional<unsigned> TransitionGraph::next(unsigned state, char symbol) const
+{
+    const auto edges = successors(state);
+    auto it = std::ranges::lower_bound(edges, symbol, {}, &Edge::symbol);
+    if (it == edges.end() || it->symbol != symbol)
+        return std::nullopt;
+    return it->state;
+}
@@ -0,0 +1,59 @@
+#ifndef TRANSITION_GRAPH_HPP
+#define TRANSITION_GRAPH_HPP
+
+#include "finite_automaton.hpp"
+
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+// The transitions of an automaton in compressed sparse row form, for algorithms which scan them state by state.
+//
+// States are numbered densely, in increasing order of the states of the automaton, as by
+// FiniteAutomaton::renumber_states. The transitions from each state are contiguous, one per target state,
+// sorted by symbol and then by target (the epsilon transition value sorts among the symbols), so reading a
+// deterministic transition takes no indirection at all. The transitions into each state are indexed the same
+// way the first time they are asked for, which is safe to do from several threads.
+class TransitionGraph
+{
+  public:
+    struct Edge
+    {
+        char symbol;
+        // The target of an outgoing transition, or the source of an incoming one.
+        unsigned state;
+    };
+
+    explicit TransitionGraph(const FiniteAutomaton &automaton);
+    // The lazily built index can't be shared between copies.
+    TransitionGraph(const TransitionGraph &) = delete;
+    TransitionGraph &operator=(const TransitionGraph &) = delete;
+
+    unsigned get_num_of_states() const { return m_original_states.size(); }
+    // The state of the automaton a state of the graph stands for.
+    unsigned get_original_state(unsigned state) const { return m_original_states[state]; }
+    // The state of the graph standing for a state of the automaton, if it is one.
+    std::optional<unsigned> get_state(unsigned original_state) const;
+
+    std::span<const Edge> successors(unsigned state) const
+    {
+        return {m_edges.data() + m_offsets[state], m_edges.data() + m_offsets[state + 1]};
+    }
+    // Sorted by symbol and then by source.
+    std::span<const Edge> predecessors(unsigned state) const;
+
+    // The first target by the symbol, which is the only one in deterministic automata.
+    std::optional<unsigned> next(unsigned state, char symbol) const;
+
+  private:
+    std::vector<unsigned> m_original_states;
+    std::vector<unsigned> m_offsets;
+    std::vector<Edge> m_edges;
+
+    mutable std::once_flag m_predecessors_built;
+    mutable std::vector<unsigned> m_predecessor_offsets;
+    mutable std::vector<Edge> m_predecessor_edges;
+};
+
+#endif // TRANSITION_GRAPH_HPP
@@ -0,0 +1,121 @@
+#include "word_enumerator.hpp"
+
+#include <algorithm>
+
+WordEnumerator::WordEnumerator(const FiniteAutomaton &automaton, unsigned max_length)
+    : m_table(automaton), m_max_length(max_length)
+{
+}
+
+WordEnumerator::iterator WordEnumerator::begin()
+{
+    if (!m_started)
+        advance();
+    return iterator(this);
+}
+
+std::default_sentinel_t WordEnumerator::end() const { return std::default_sentinel; }
+
+bool WordEnumerator::advance()
+{
+    if (m_done)
+        return false;
+
+    if (m_started && advance_within_length(false))
+        return true;
+
+    for (m_length = m_started ? m_length + 1 : 0; m_length <= m_max_length; ++m_length) {
+        m_started = true;
+
+        // Once no word of some length exists, no longer words can exist either.
+        if (!extend_feasible(m_length))
+            break;
+
+        if (m_feasible[m_length][m_table.get_initial_state()]) {
+            m_word.assign(m_length, '\0');
+            m_states.assign(m_length + 1, m_table.get_initial_state());
+            m_symbol_indices.assign(m_length + 1, 0);
+            if (advance_within_length(true))
+                return true;
+        }
+    }
+
+    m_done = true;
+    return false;
+}
+
+// Depth-first search for the next word of the current length, resuming from the last one found.
+bool WordEnumerator::advance_within_length(bool first)
+{
+    const auto &alphabet = m_table.get_alphabet();
+
+    unsigned depth = 0;
+    if (!first) {
+        if (m_length == 0)
+            return false;
+        depth = m_length - 1;
+        ++m_symbol_indices[depth];
+    }
+
+    while (depth < m_length) {
+        const auto &feasible = m_feasible[m_length - depth - 1];
+
+        bool found = false;
+        for (auto &i = m_symbol_indices[depth]; i < alphabet.size(); ++i) {
+            const auto to_state = m_table.next(m_states[depth], alphabet[i]);
+            if (feasible[to_state]) {
+                m_word[depth] = alphabet[i];
+                m_states[depth + 1] = to_state;
+                found = true;
+                break;
+            }
+        }
+
+        if (found)
+            m_symbol_indices[++depth] = 0;
+        else if (depth == 0)
+            return false;
+        else
+            ++m_symbol_indices[--depth];
+    }
+
+    return true;
+}
+
+bool WordEnumerator::extend_feasible(unsigned length)
+{
+    const auto num_of_states = m_table.get_num_of_states();
+    const auto num_of_classes = m_table.get_num_of_classes();
+
+    if (m_feasible.empty()) {
+        auto &feasible = m_feasible.emplace_back(num_of_states, false);
+        for (unsigned state = 0; state < num_of_states; ++state)
+            feasible[state] = m_table.is_final(state);
+    }
+
+    while (m_feasible.size() <= length) {
+        const auto &previous = m_feasible.back();
+        std::vector<char> feasible(num_of_states, false);
+        for (unsigned state = 0; state < num_of_states; ++state) {
+            for (unsigned symbol_class = 1; symbol_class < num_of_classes && !feasible[state]; ++symbol_class)
+                feasible[state] = previous[m_table.next_by_class(state, symbol_class)];
+        }
+        m_feasible.push_back(std::move(feasible));
+    }
+
+    return std::ranges::any_of(m_feasible[length], [](char feasible) { return feasible; });
+}
+
+WordEnumerator::iterator::iterator(WordEnumerator *enumerator) : m_enumerator(enumerator) {}
+
+std::string_view WordEnumerator::iterator::operator*() const { return m_enumerator->m_word; }
+
+WordEnumerator::iterator &WordEnumerator::iterator::operator++()
+{
+    m_enumerator->advance();
+    return *this;
+}
+
+void WordEnumerator::iterator::operator++(int) { ++*this; }
+
+bool WordEnumerator::iterator::operator==(std::default_sentinel_t) const { return m_enumerator->m_done; }
@@ -0,0 +1,65 @@
+#ifndef WORD_ENUMERATOR_HPP
+#define WORD_ENUMERATOR_HPP
+
+#include "dfa_table.hpp"
+#include "finite_automaton.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Lazy range of the words accepted by an automaton, up to a maximum length, in shortlex
+// (length, then lexicographic) order. Only the words themselves are ever visited, since
+// each branch is pruned unless it can still reach a final state in exactly the number of
+// remaining steps. All words are written into the same buffer, so the yielded views are
+// only valid until the next increment.
+//
+// Like a generator, the range is single pass: it must not be moved once begin() is called.
+class WordEnumerator
+{
+  public:
+    class iterator;
+
+    WordEnumerator(const FiniteAutomaton &automaton, unsigned max_length);
+
+    iterator begin();
+    std::default_sentinel_t end() const;
+
+  private:
+    bool advance();
+    bool advance_within_length(bool first);
+    bool extend_feasible(unsigned length);
+
+    DfaTable m_table;
+    unsigned m_max_length;
+    // Whether a final state can be reached in exactly the given number of steps, by state.
+    std::vector<std::vector<char>> m_feasible;
+
+    bool m_started = false, m_done = false;
+    unsigned m_length = 0;
+    std::string m_word;
+    std::vector<unsigned> m_states;
+    std::vector<unsigned> m_symbol_indices;
+};
+
+class WordEnumerator::iterator
+{
+  public:
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+    explicit iterator(WordEnumerator *enumerator);
+
+    std::string_view operator*() const;
+    iterator &operator++();
+    void operator++(int);
+    bool operator==(std::default_sentinel_t) const;
+
+  private:
+    WordEnumerator *m_enumerator = nullptr;
+};
+
+#endif // WORD_ENUMERATOR_HPP
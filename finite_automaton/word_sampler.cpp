@@ -0,0 +1,149 @@
+#include "word_sampler.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+
+WordSampler::WordSampler(const FiniteAutomaton &automaton, std::mt19937::result_type seed)
+    : m_table(automaton.minimize()), m_random_engine(seed)
+{
+    const auto num_of_states = m_table.get_num_of_states();
+    const auto num_of_classes = m_table.get_num_of_classes();
+    const auto dead_state = m_table.get_dead_state();
+
+    m_class_sizes.assign(num_of_classes, 0);
+    m_class_symbols.assign(num_of_classes, "");
+    for (const auto &symbol : m_table.get_alphabet()) {
+        const auto symbol_class = m_table.get_class(symbol);
+        ++m_class_sizes[symbol_class];
+        m_class_symbols[symbol_class] += symbol;
+    }
+
+    std::vector<std::vector<unsigned>> predecessors(num_of_states);
+    for (unsigned state = 0; state < dead_state; ++state) {
+        for (unsigned symbol_class = 1; symbol_class < num_of_classes; ++symbol_class) {
+            const auto to_state = m_table.next_by_class(state, symbol_class);
+            if (to_state != dead_state)
+                predecessors[to_state].push_back(state);
+        }
+    }
+
+    m_distances.assign(num_of_states, std::numeric_limits<unsigned>::max());
+    std::queue<unsigned> state_queue;
+    for (unsigned state = 0; state < dead_state; ++state) {
+        if (m_table.is_final(state)) {
+            m_distances[state] = 0;
+            state_queue.push(state);
+        }
+    }
+    while (!state_queue.empty()) {
+        const auto current_state = state_queue.front();
+        state_queue.pop();
+        for (const auto &state : predecessors[current_state]) {
+            if (m_distances[state] == std::numeric_limits<unsigned>::max()) {
+                m_distances[state] = m_distances[current_state] + 1;
+                state_queue.push(state);
+            }
+        }
+    }
+}
+
+std::optional<std::string> WordSampler::shortest_word() const
+{
+    auto state = m_table.get_initial_state();
+    if (state == m_table.get_dead_state())
+        return std::nullopt;
+
+    // Every live state has a successor one step closer to a final state,
+    // so following the smallest such symbol gives the shortlex minimum.
+    std::string word;
+    word.reserve(m_distances[state]);
+    while (m_distances[state] > 0) {
+        for (const auto &symbol : m_table.get_alphabet()) {
+            const auto to_state = m_table.next(state, symbol);
+            if (m_distances[to_state] == m_distances[state] - 1) {
+                word += symbol;
+                state = to_state;
+                break;
+            }
+        }
+    }
+
+    return word;
+}
+
+std::optional<std::string> WordSampler::random_word(unsigned length)
+{
+    auto state = m_table.get_initial_state();
+    if (state == m_table.get_dead_state())
+        return std::nullopt;
+
+    extend_counts(length);
+    if (m_counts[length][state] == 0)
+        return std::nullopt;
+
+    // Each symbol is chosen with a probability proportional to the
+    // number of accepted words which can still follow after it.
+    std::string word;
+    word.reserve(length);
+    const auto num_of_classes = m_table.get_num_of_classes();
+    for (unsigned remaining = length; remaining > 0; --remaining) {
+        const auto &counts = m_counts[remaining - 1];
+        const auto weight = [&](unsigned symbol_class) {
+            return m_class_sizes[symbol_class] * counts[m_table.next_by_class(state, symbol_class)];
+        };
+
+        double total_weight = 0;
+        for (unsigned symbol_class = 1; symbol_class < num_of_classes; ++symbol_class)
+            total_weight += weight(symbol_class);
+
+        std::uniform_real_distribution<double> random_weight(0, total_weight);
+        auto remaining_weight = random_weight(m_random_engine);
+        unsigned symbol_class = 0;
+        for (unsigned candidate = 1; candidate < num_of_classes; ++candidate) {
+            if (weight(candidate) == 0)
+                continue;
+            symbol_class = candidate;
+            remaining_weight -= weight(candidate);
+            if (remaining_weight < 0)
+                break;
+        }
+
+        const auto &symbols = m_class_symbols[symbol_class];
+        std::uniform_int_distribution<size_t> random_symbol(0, symbols.size() - 1);
+
+        word += symbols[random_symbol(m_random_engine)];
+        state = m_table.next_by_class(state, symbol_class);
+    }
+
+    return word;
+}
+
+void WordSampler::extend_counts(unsigned length)
+{
+    const auto num_of_states = m_table.get_num_of_states();
+    const auto num_of_classes = m_table.get_num_of_classes();
+    const auto dead_state = m_table.get_dead_state();
+
+    if (m_counts.empty()) {
+        auto &counts = m_counts.emplace_back(num_of_states, 0);
+        for (unsigned state = 0; state < dead_state; ++state)
+            counts[state] = m_table.is_final(state) ? 1 : 0;
+    }
+
+    while (m_counts.size() <= length) {
+        const auto &previous = m_counts.back();
+        std::vector<double> counts(num_of_states, 0);
+        for (unsigned state = 0; state < dead_state; ++state) {
+            for (unsigned symbol_class = 1; symbol_class < num_of_classes; ++symbol_class)
+                counts[state] += m_class_sizes[symbol_class] * previous[m_table.next_by_class(state, symbol_class)];
+        }
+
+        const auto max_count = std::ranges::max(counts);
+        if (max_count > 0) {
+            for (auto &count : counts)
+                count /= max_count;
+        }
+        m_counts.push_back(std::move(counts));
+    }
+}
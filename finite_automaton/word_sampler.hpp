@@ -0,0 +1,40 @@
+#ifndef WORD_SAMPLER_HPP
+#define WORD_SAMPLER_HPP
+
+#include "dfa_table.hpp"
+#include "finite_automaton.hpp"
+
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+// Generates words accepted by an automaton. The automaton is compiled once, on construction,
+// so that a query only takes time linear in the length of the word (times the number of symbol
+// classes). Each sampler has its own random engine, so separate samplers can be used from
+// separate threads.
+class WordSampler
+{
+  public:
+    explicit WordSampler(const FiniteAutomaton &automaton, std::mt19937::result_type seed = std::random_device{}());
+
+    // The shortest accepted word, lexicographically smallest among those of its length.
+    std::optional<std::string> shortest_word() const;
+    // An accepted word of the given length, all of them being equally likely.
+    std::optional<std::string> random_word(unsigned length);
+
+  private:
+    void extend_counts(unsigned length);
+
+    DfaTable m_table;
+    std::vector<unsigned> m_class_sizes;
+    std::vector<std::string> m_class_symbols;
+    // Distance of each state to the closest final state.
+    std::vector<unsigned> m_distances;
+    // Number of accepted words of each length from each state, scaled per length (so as not to
+    // overflow), which is fine since only the counts of the same length are ever compared.
+    std::vector<std::vector<double>> m_counts;
+    std::mt19937 m_random_engine;
+};
+
+#endif // WORD_SAMPLER_HPP
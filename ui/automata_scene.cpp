@@ -4,13 +4,18 @@
 #include "finite_automaton.hpp"
 #include "utility.hpp"
 
-#include <QDataStream>
 #include <QFile>
 #include <QGraphicsSceneMouseEvent>
+#include <QTimer>
 #include <QWidget>
 
 using namespace Ui;
 
+namespace {
+// The key under which a placeholder of an automaton that failed to load keeps its serialized form.
+constexpr int failed_data_key = 0;
+} // namespace
+
 AutomataScene::AutomataScene(QWidget *parent) : QGraphicsScene(parent) {}
 
 QString AutomataScene::get_name() const { return m_name; }
@@ -19,108 +24,101 @@ void AutomataScene::undo_action() { m_undo_stack->undo(); }
 
 void AutomataScene::redo_action() { m_undo_stack->redo(); }
 
-namespace {
-std::expected<FiniteAutomaton, QString> deserialize_automaton(QDataStream &in)
+std::expected<AutomataScene *, QString> AutomataScene::load_from_file(const QString &file_name, QWidget *parent)
 {
-    QSet<char> q_alphabet;
-    QSet<unsigned> q_states, q_initial_states, q_final_states;
-    QMap<QPair<unsigned, char>, QSet<unsigned>> q_transition_function;
-
-    in >> q_alphabet >> q_states >> q_initial_states >> q_final_states >> q_transition_function;
-    if (in.status() != QDataStream::Ok)
-        return std::unexpected("File format error");
-
-    std::set<char> alphabet(q_alphabet.begin(), q_alphabet.end());
-    std::set<unsigned> states(q_states.begin(), q_states.end());
-    std::set<unsigned> initial_states(q_initial_states.begin(), q_initial_states.end());
-    std::set<unsigned> final_states(q_final_states.begin(), q_final_states.end());
-    std::map<std::pair<unsigned, char>, std::set<unsigned>> transition_function;
-    QMapIterator<QPair<unsigned, char>, QSet<unsigned>> it(q_transition_function);
-    while (it.hasNext()) {
-        it.next();
-        transition_function[{it.key().first, it.key().second}] =
-            std::set<unsigned>(it.value().begin(), it.value().end());
+    auto file = MappedFile::open(file_name.toStdString());
+    if (!file)
+        return std::unexpected(QString::fromStdString(file.error()));
+
+    // The index refers to the contents of the file, so the file is kept in place as long as the index is needed.
+    auto mapped_file = std::make_unique<MappedFile>(std::move(*file));
+    auto index = SceneFile::Index::read(mapped_file->get_contents());
+    if (!index)
+        return std::unexpected(QString::fromStdString(index.error()));
+
+    AutomataScene *scene = new AutomataScene(parent);
+    for (size_t i = 0; i < index->size(); ++i) {
+        const auto [x, y] = index->get_center(i);
+        auto *placeholder = new QGraphicsSimpleTextItem("Loading...");
+        Utility::add_item_at_pos(placeholder, scene, QPointF(x, y));
+        scene->m_placeholders.append({placeholder, i});
     }
+    scene->m_file = std::move(mapped_file);
+    scene->m_index = std::move(*index);
+    scene->m_name = file_name;
 
-    auto automaton = FiniteAutomaton::construct(alphabet, states, initial_states, final_states, transition_function);
-    if (!automaton)
-        return std::unexpected(QString::fromUtf8(automaton.error().c_str()));
-
-    return *automaton;
-}
-
-std::expected<AutomataScene *, QString> deserialize_scene(QDataStream &in)
-{
-    AutomataScene *scene = new AutomataScene;
-    qsizetype num_of_automata;
-    in >> num_of_automata;
-    for (qsizetype i = 0; i < num_of_automata; ++i) {
-        auto automaton = deserialize_automaton(in);
-        QPointF pos;
-        in >> pos;
-        if (in.status() != QDataStream::Ok || !automaton) {
-            delete scene;
-            return std::unexpected("File format error");
-        }
-        Utility::add_item_at_pos(new AutomatonGraph(*automaton), scene, pos);
-    }
+    QTimer::singleShot(0, scene, &AutomataScene::load_next_placeholder);
 
     return scene;
 }
-} // namespace
 
-std::expected<AutomataScene *, QString> AutomataScene::load_from_file(const QString &file_name, QWidget *parent)
+void AutomataScene::load_next_placeholder()
 {
-    QFile file(file_name);
-    if (!file.open(QIODevice::ReadOnly))
-        return std::unexpected(file.errorString());
+    if (m_placeholders.empty())
+        return finish_loading();
 
-    QDataStream in(&file);
-    auto scene = deserialize_scene(in);
-    file.close();
+    const auto [placeholder, index] = m_placeholders.takeFirst();
+    load_placeholder(placeholder, index);
 
-    if (scene) {
-        scene.value()->m_name = file_name;
-        scene.value()->setParent(parent);
-    }
-
-    return scene;
+    // Going back to the event loop between automata keeps the UI responsive while loading.
+    QTimer::singleShot(0, this, &AutomataScene::load_next_placeholder);
 }
 
-namespace {
-void serialize_automaton(QDataStream &out, const FiniteAutomaton &automaton)
+void AutomataScene::load_placeholder(QGraphicsSimpleTextItem *placeholder, size_t index)
 {
-    QSet<char> alphabet(automaton.get_alphabet().begin(), automaton.get_alphabet().end());
-    QSet<unsigned> states(automaton.get_states().begin(), automaton.get_states().end());
-    QSet<unsigned> initial_states(automaton.get_initial_states().begin(), automaton.get_initial_states().end());
-    QSet<unsigned> final_states(automaton.get_final_states().begin(), automaton.get_final_states().end());
-    QMap<QPair<unsigned, char>, QSet<unsigned>> transition_function;
-    for (const auto &[k, v] : automaton.get_transition_function())
-        transition_function.insert(k, QSet<unsigned>(v.begin(), v.end()));
-
-    out << alphabet << states << initial_states << final_states << transition_function;
+    auto automaton = m_index->load(index);
+    if (!automaton) {
+        // The placeholder is kept in place of the automaton, to tell why it is missing, along with the data
+        // of the automaton, which is saved back as it is.
+        placeholder->setText("Failed to load: " + QString::fromStdString(automaton.error()));
+        const auto data = m_index->get_data(index);
+        placeholder->setData(failed_data_key, QByteArray(data.data(), data.size()));
+        return;
+    }
+
+    const auto center = Utility::get_center_pos(placeholder);
+    removeItem(placeholder);
+    delete placeholder;
+    Utility::add_item_at_pos(new AutomatonGraph(*automaton), this, center);
 }
 
-void serialize_scene(QDataStream &out, AutomataScene *scene)
+void AutomataScene::finish_loading()
 {
-    auto graphs = Utility::get_items<AutomatonGraph>(scene);
-    out << graphs.size();
-    for (auto *graph : graphs) {
-        serialize_automaton(out, graph->get_automaton());
-        out << Utility::get_center_pos(graph);
+    while (!m_placeholders.empty()) {
+        const auto [placeholder, index] = m_placeholders.takeFirst();
+        load_placeholder(placeholder, index);
     }
+
+    m_index.reset();
+    m_file.reset();
 }
-} // namespace
 
 // In case the save operation fails, an error is returned.
 std::optional<QString> AutomataScene::save_to_file(const QString &file_name)
 {
+    // Also releases the opened file, which might be the one being overwritten.
+    finish_loading();
+
+    std::vector<SceneFile::Item> items;
+    for (auto *graph : Utility::get_items<AutomatonGraph>(this)) {
+        const auto pos = Utility::get_center_pos(graph);
+        items.push_back({graph->get_automaton(), pos.x(), pos.y()});
+    }
+    std::vector<SceneFile::RawItem> raw_items;
+    for (auto *placeholder : Utility::get_items<QGraphicsSimpleTextItem>(this)) {
+        const auto data = placeholder->data(failed_data_key);
+        if (!data.isValid())
+            continue;
+        const auto pos = Utility::get_center_pos(placeholder);
+        raw_items.push_back({data.toByteArray().toStdString(), pos.x(), pos.y()});
+    }
+    const auto contents = SceneFile::write(items, raw_items);
+
     QFile file(file_name);
     if (!file.open(QIODevice::WriteOnly))
         return file.errorString();
-
-    QDataStream out(&file);
-    serialize_scene(out, this);
+    if (file.write(contents.data(), contents.size()) != static_cast<qint64>(contents.size()))
+        return file.errorString();
     file.close();
 
     m_name = file_name;
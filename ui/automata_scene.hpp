@@ -1,11 +1,16 @@
 #ifndef UI_AUTOMATA_SCENE_HPP
 #define UI_AUTOMATA_SCENE_HPP
 
+#include "mapped_file.hpp"
+#include "scene_file.hpp"
+
 #include <QGraphicsScene>
+#include <QGraphicsSimpleTextItem>
 #include <QStack>
 #include <QUndoCommand>
 
 #include <expected>
+#include <memory>
 #include <optional>
 
 namespace Ui {
@@ -40,9 +45,19 @@ class AutomataScene : public QGraphicsScene
     void mouseReleaseEvent(QGraphicsSceneMouseEvent *event) override;
 
   private:
+    // The automata of an opened file are shown as placeholders at first, which are replaced one
+    // at a time, in the background, so that the file doesn't have to be decoded and laid out at once.
+    void load_next_placeholder();
+    void load_placeholder(QGraphicsSimpleTextItem *placeholder, size_t index);
+    void finish_loading();
+
     QString m_name;
     QUndoStack *m_undo_stack = new QUndoStack(this);
     QList<QPair<QGraphicsItem *, QPointF>> m_moving_items;
+
+    std::unique_ptr<MappedFile> m_file;
+    std::optional<SceneFile::Index> m_index;
+    QList<QPair<QGraphicsSimpleTextItem *, size_t>> m_placeholders;
 };
 
 class AutomataScene::AddCommand : public QUndoCommand
@@ -166,7 +166,9 @@ void CreationDock::construct_by_element()
         transition_function[{from_state, transition_symbol}].insert(to_state);
     }
 
-    auto automaton = FiniteAutomaton::construct(alphabet, states, initial_states, final_states, transition_function);
+    auto automaton = FiniteAutomaton::construct(
+        std::move(alphabet), std::move(states), std::move(initial_states), std::move(final_states),
+        std::move(transition_function));
     if (automaton) {
         auto graph = new AutomatonGraph(*automaton);
         m_current_scene->add_automata({{graph, m_viewport_center}});
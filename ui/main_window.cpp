@@ -53,6 +53,7 @@ void MainWindow::setup()
     connect(m_tab_bar, &SceneTabBar::scene_changed, m_creation_dock, &CreationDock::set_scene);
     connect(m_tab_bar, &SceneTabBar::scene_changed, m_operations_dock, &OperationsDock::set_scene);
 
+    connect(m_main_view, &MainGraphicsView::viewport_center_changed, m_menu_bar, &MenuBar::set_viewport_center);
     connect(
         m_main_view, &MainGraphicsView::viewport_center_changed, m_creation_dock, &CreationDock::set_viewport_center);
     connect(
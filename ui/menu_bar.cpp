@@ -6,6 +6,7 @@
 
 #include "automaton_graph.hpp"
 #include "finite_automaton.hpp"
+#include "mapped_file.hpp"
 
 using namespace Ui;
 using namespace Ui::Utility;
@@ -21,6 +22,8 @@ MenuBar::MenuBar(QWidget *parent) : QMenuBar(parent)
 
 void MenuBar::set_scene(AutomataScene *scene) { m_current_scene = scene; }
 
+void MenuBar::set_viewport_center(QPointF center) { m_viewport_center = center; }
+
 void MenuBar::build_file_menu()
 {
     m_file_menu = this->addMenu("&File");
@@ -31,6 +34,8 @@ void MenuBar::build_file_menu()
     m_open_action = m_file_menu->addAction("Open");
     m_open_action->setShortcuts(QKeySequence::Open);
 
+    m_import_action = m_file_menu->addAction("Import");
+
     m_save_action = m_file_menu->addAction("Save");
     m_save_action->setShortcuts(QKeySequence::Save);
 
@@ -46,6 +51,8 @@ void MenuBar::setup_file_menu()
 
     connect(m_open_action, &QAction::triggered, this, [=]() { open_with_dialog(); });
 
+    connect(m_import_action, &QAction::triggered, this, [=]() { import_with_dialog(); });
+
     connect(m_save_action, &QAction::triggered, this, [=]() {
         auto scene_name = m_current_scene->get_name();
         if (scene_name.isEmpty())
@@ -93,6 +100,28 @@ void MenuBar::open_with_dialog()
     }
 }
 
+void MenuBar::import_with_dialog()
+{
+    QString file_name =
+        QFileDialog::getOpenFileName(this, "Import File", "", "Automaton Transitions (*.fa);;All Files (*)");
+    if (file_name.isEmpty())
+        return;
+
+    auto file = MappedFile::open(file_name.toStdString());
+    if (!file) {
+        QMessageBox::information(this, "File error", QString::fromStdString(file.error()));
+        return;
+    }
+
+    auto automaton = FiniteAutomaton::from_text(file->get_contents());
+    if (!automaton) {
+        QMessageBox::information(this, "File error", QString::fromStdString(automaton.error()));
+        return;
+    }
+
+    m_current_scene->add_automata({{new AutomatonGraph(*automaton), m_viewport_center}});
+}
+
 void MenuBar::build_edit_menu()
 {
     m_edit_menu = this->addMenu("&Edit");
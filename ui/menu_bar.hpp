@@ -16,6 +16,7 @@ class MenuBar : public QMenuBar
 
   public slots:
     void set_scene(AutomataScene *scene);
+    void set_viewport_center(QPointF center);
 
   signals:
     void scene_opened(AutomataScene *scene);
@@ -28,6 +29,7 @@ class MenuBar : public QMenuBar
     void save_file(const QString &file_name);
     void save_with_dialog();
     void open_with_dialog();
+    void import_with_dialog();
 
     void build_edit_menu();
     void setup_edit_menu();
@@ -35,6 +37,7 @@ class MenuBar : public QMenuBar
     QMenu *m_file_menu;
     QAction *m_new_action;
     QAction *m_open_action;
+    QAction *m_import_action;
     QAction *m_save_action;
     QAction *m_save_as_action;
     QAction *m_close_action;
@@ -44,6 +47,7 @@ class MenuBar : public QMenuBar
     QAction *m_redo_action;
 
     AutomataScene *m_current_scene;
+    QPointF m_viewport_center;
 };
 } // namespace Ui
 
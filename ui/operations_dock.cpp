@@ -120,9 +120,11 @@ void OperationsDock::build_unary_group()
     m_complete_btn = new QPushButton("Complete");
     m_reverse_btn = new QPushButton("Reverse");
     m_complement_btn = new QPushButton("Complement");
+    m_trim_btn = new QPushButton("Trim");
 
     auto unary_group = create_operation_group(
-        "Unary", new QVBoxLayout, {m_determinize_btn, m_minimize_btn, m_complete_btn, m_reverse_btn, m_complement_btn});
+        "Unary", new QVBoxLayout,
+        {m_determinize_btn, m_minimize_btn, m_complete_btn, m_reverse_btn, m_complement_btn, m_trim_btn});
     this->widget()->layout()->addWidget(unary_group);
 }
 
@@ -147,6 +149,10 @@ void OperationsDock::setup_unary_group()
     connect(m_complement_btn, &QPushButton::clicked, this, [=]() {
         execute_unary_operation(m_current_scene, &FiniteAutomaton::complement);
     });
+
+    connect(m_trim_btn, &QPushButton::clicked, this, [=]() {
+        execute_unary_operation(m_current_scene, &FiniteAutomaton::trim);
+    });
 }
 
 void OperationsDock::build_binary_group()
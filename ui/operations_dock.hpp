@@ -36,6 +36,7 @@ class OperationsDock : public QDockWidget
     QPushButton *m_complete_btn;
     QPushButton *m_reverse_btn;
     QPushButton *m_complement_btn;
+    QPushButton *m_trim_btn;
 
     QPushButton *m_union_btn;
     QPushButton *m_intersection_btn;
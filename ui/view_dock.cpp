@@ -2,6 +2,9 @@
 #include "utility.hpp"
 
 #include <QApplication>
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QLayout>
 #include <QLineEdit>
 #include <QPushButton>
@@ -10,9 +13,11 @@
 #include <QWheelEvent>
 
 #include <optional>
+#include <span>
 #include <ranges>
 
 #include "automaton_graph.hpp"
+#include "cpp_generator.hpp"
 #include "finite_automaton.hpp"
 #include "match_simulator.hpp"
 
@@ -70,6 +75,7 @@ ViewDock::ViewDock(QWidget *parent) : QDockWidget(parent)
     build_match_section();
     main_layout->addWidget(create_h_line());
     build_regex_section();
+    build_code_section();
     m_view_info = new QLabel("");
     m_view_info->setWordWrap(true);
     main_layout->addWidget(m_view_info);
@@ -77,6 +83,7 @@ ViewDock::ViewDock(QWidget *parent) : QDockWidget(parent)
     setup_view_section();
     setup_match_section();
     setup_regex_section();
+    setup_code_section();
 }
 
 void ViewDock::set_scene(AutomataScene *scene) { m_current_scene = scene; }
@@ -210,6 +217,52 @@ void ViewDock::setup_regex_section()
     });
 }
 
+void ViewDock::build_code_section()
+{
+    m_code_btn = new QPushButton("Export C++");
+    m_code_style_cb = new QComboBox;
+    m_code_style_cb->addItems({"Table", "Switch"});
+
+    auto code_section = new QWidget;
+    auto code_layout = new QHBoxLayout(code_section);
+    code_layout->setContentsMargins(0, 0, 0, 0);
+    code_layout->addWidget(m_code_btn);
+    code_layout->addWidget(m_code_style_cb);
+    this->widget()->layout()->addWidget(code_section);
+}
+
+void ViewDock::setup_code_section()
+{
+    connect(m_code_btn, &QPushButton::clicked, this, [=]() {
+        m_view_info->setText("");
+        auto graphs = get_items<AutomatonGraph>(m_side_view->scene());
+        if (graphs.size() == 0) {
+            m_view_info->setText("An automaton must be selected.");
+            return;
+        }
+
+        QString file_name = QFileDialog::getSaveFileName(this, "Export C++", "", "C++ Header (*.hpp);;All Files (*)");
+        if (file_name.isEmpty())
+            return;
+
+        // The matcher is named after the file.
+        const auto function_name =
+            CppGenerator::to_identifier(QFileInfo(file_name).completeBaseName().toStdString());
+        const auto style =
+            m_code_style_cb->currentIndex() == 0 ? CppGenerator::Style::Table : CppGenerator::Style::Switch;
+        auto function = CppGenerator::generate_function(graphs.at(0)->get_automaton(), function_name, style);
+        if (!function) {
+            m_view_info->setText(QString::fromStdString(function.error()));
+            return;
+        }
+
+        const auto contents = CppGenerator::generate_header(std::span(&*function, 1));
+        QFile file(file_name);
+        if (!file.open(QIODevice::WriteOnly) || file.write(contents.data(), contents.size()) == -1)
+            m_view_info->setText("Cannot write file: " + file_name);
+    });
+}
+
 ViewDock::SideGraphicsView::SideGraphicsView(QWidget *parent) : QGraphicsView(parent)
 {
     setDragMode(QGraphicsView::ScrollHandDrag);
@@ -1,6 +1,7 @@
 #ifndef UI_VIEW_DOCK_HPP
 #define UI_VIEW_DOCK_HPP
 
+#include <QComboBox>
 #include <QDockWidget>
 #include <QGraphicsView>
 #include <QLabel>
@@ -30,6 +31,9 @@ class ViewDock : public QDockWidget
     void build_regex_section();
     void setup_regex_section();
 
+    void build_code_section();
+    void setup_code_section();
+
     SideGraphicsView *m_side_view;
     QPushButton *m_view_btn;
 
@@ -40,6 +44,9 @@ class ViewDock : public QDockWidget
     QPushButton *m_regex_btn;
     QLineEdit *m_regex_le;
 
+    QPushButton *m_code_btn;
+    QComboBox *m_code_style_cb;
+
     QLabel *m_view_info;
 
     AutomataScene *m_current_scene;